@@ -10,19 +10,18 @@ struct DirLight {
     vec3 specular;
 };
 
+// laid out to match std140 without padding.
 struct PointLight {
-    vec3 position;
+    vec4 position;
+    // constant, linear, quadratic
+    vec4 attenuation;
 
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 };
 
-#define MAX_POINT_LIGHTS 4
+// MAX_POINT_LIGHTS is defined by the renderer.
 
 struct Material {
     sampler2D diffuse;
@@ -40,11 +39,39 @@ inv;
 
 uniform Material material;
 
-uniform PointLight point_lights[MAX_POINT_LIGHTS];
+layout(std140) uniform Lighting
+{
+    int n_point_lights;
+    DirLight dir_light;
+};
 
-uniform DirLight dir_light;
+layout(std140) uniform PointLights
+{
+    PointLight point_lights[MAX_POINT_LIGHTS];
+};
 
-uniform int n_point_lights;
+// clustered lighting, see LightClusters.
+uniform int cluster_mode;
+// offset and count into cluster_lights for each froxel.
+uniform usamplerBuffer cluster_grid;
+uniform usamplerBuffer cluster_lights;
+// every point light as 5 texels.
+uniform samplerBuffer light_data;
+uniform ivec3 cluster_dims;
+// tile size in pixels.
+uniform vec2 cluster_tile;
+// maps log(view depth) to a depth slice.
+uniform vec2 cluster_slicing;
+
+PointLight fetch_light(int i)
+{
+    int base = i * 5;
+    return PointLight(texelFetch(light_data, base),
+                      texelFetch(light_data, base + 1),
+                      texelFetch(light_data, base + 2),
+                      texelFetch(light_data, base + 3),
+                      texelFetch(light_data, base + 4));
+}
 
 vec3 calc_dir_light(DirLight light, vec3 normal, vec3 view_dir, Material m)
 {
@@ -65,22 +92,24 @@ vec3 calc_dir_light(DirLight light, vec3 normal, vec3 view_dir, Material m)
 
 vec3 calc_point_light(PointLight light, vec3 normal, vec3 view_dir, Material m)
 {
-    vec3 light_dir = normalize(light.position - inv.frag_pos);
+    vec3 light_dir = normalize(light.position.xyz - inv.frag_pos);
     // diffuse
     float diff = max(dot(normal, light_dir), 0.0);
     // specular
     vec3 reflect_dir = reflect(-light_dir, normal);
     float spec = pow(max(dot(view_dir, reflect_dir), 0.0), m.shine);
     // attenuation
-    float dist = length(light.position - inv.frag_pos);
-    float attenuation = 1.0 / (light.constant + light.linear * dist +
-                               light.quadratic * (dist * dist));
+    float dist = length(light.position.xyz - inv.frag_pos);
+    float attenuation =
+        1.0 / (light.attenuation.x + light.attenuation.y * dist +
+               light.attenuation.z * (dist * dist));
 
     // sample & combine
-    vec3 ambient = light.ambient * texture(m.diffuse, inv.texcoord).rgb;
-    vec3 diffuse = light.diffuse * diff * texture(m.diffuse, inv.texcoord).rgb;
+    vec3 ambient = light.ambient.rgb * texture(m.diffuse, inv.texcoord).rgb;
+    vec3 diffuse =
+        light.diffuse.rgb * diff * texture(m.diffuse, inv.texcoord).rgb;
     vec3 specular =
-        light.specular * spec * texture(m.specular, inv.texcoord).rgb;
+        light.specular.rgb * spec * texture(m.specular, inv.texcoord).rgb;
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
@@ -94,9 +123,25 @@ void main()
 
     vec3 light_total = calc_dir_light(dir_light, norm, view_dir, material);
 
-    for (int i = 0; i < n_point_lights; ++i) {
-        light_total +=
-            calc_point_light(point_lights[i], norm, view_dir, material);
+    if (cluster_mode != 0) {
+        float depth = -(view * vec4(inv.frag_pos, 1.0)).z;
+        int slice = int(log(depth) * cluster_slicing.x + cluster_slicing.y);
+        ivec3 cell = clamp(ivec3(ivec2(gl_FragCoord.xy / cluster_tile), slice),
+                           ivec3(0), cluster_dims - 1);
+        int idx =
+            cell.x + cluster_dims.x * (cell.y + cluster_dims.y * cell.z);
+        uvec2 list = texelFetch(cluster_grid, idx).xy;
+        for (uint i = 0u; i < list.y; ++i) {
+            int light = int(texelFetch(cluster_lights, int(list.x + i)).r);
+            light_total +=
+                calc_point_light(fetch_light(light), norm, view_dir, material);
+        }
+    }
+    else {
+        for (int i = 0; i < n_point_lights; ++i) {
+            light_total +=
+                calc_point_light(point_lights[i], norm, view_dir, material);
+        }
     }
 
     frag_color = vec4(light_total, 1.0);
@@ -6,6 +6,8 @@ out vec4 gl_Position;
 layout(location = 0) in vec3 a_pos;
 layout(location = 1) in vec3 a_normal;
 layout(location = 2) in vec2 a_texcoord;
+// per-instance
+layout(location = 3) in mat4 a_model;
 
 out VERT_OUT
 {
@@ -15,12 +17,10 @@ out VERT_OUT
 }
 outv;
 
-uniform mat4 model;
-
 void main()
 {
-    gl_Position = projection * view * model * vec4(a_pos, 1.0);
-    outv.frag_pos = vec3(model * vec4(a_pos, 1.0));
+    gl_Position = projection * view * a_model * vec4(a_pos, 1.0);
+    outv.frag_pos = vec3(a_model * vec4(a_pos, 1.0));
     outv.texcoord = a_texcoord;
-    outv.normal = vec3(model * vec4(a_normal, 0.0));
+    outv.normal = vec3(a_model * vec4(a_normal, 0.0));
 }
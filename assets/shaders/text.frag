@@ -2,16 +2,22 @@
 #include "common.glsl"
 
 in vec2 tex_coord;
+flat in float layer;
+flat in vec4 color;
 
 out vec4 f_color;
 
 uniform sampler2DArray glyph;
-uniform vec3 text_color;
-uniform int chidx;
+// glyphs are signed distance fields, with the outline at 0.5.
+uniform int sdf;
 
 void main()
 {
-    float alpha = texture(glyph, vec3(tex_coord, chidx)).r;
-    f_color = vec4(1.0, 1.0, 1.0, alpha) * vec4(text_color, 1.0);
-    // f_color = vec4(1.0, 0.0, 0.0, 1.0);
+    float alpha = texture(glyph, vec3(tex_coord, layer)).r;
+    if (sdf != 0) {
+        // antialias over about one screen pixel at any scale.
+        float w = max(fwidth(alpha), 1e-4) * 0.7;
+        alpha = smoothstep(0.5 - w, 0.5 + w, alpha);
+    }
+    f_color = vec4(color.rgb, color.a * alpha);
 }
@@ -4,13 +4,21 @@
 out vec4 gl_Position;
 
 layout(location = 0) in vec4 vertex; // {posx, posy, tex_x, tex_y}
-
-uniform vec2 origin;
+// per-glyph
+layout(location = 1) in vec2 g_pos;
+layout(location = 2) in vec2 g_size;
+layout(location = 3) in vec4 g_uv; // {left, top, right, bottom}
+layout(location = 4) in float g_layer;
+layout(location = 5) in vec4 g_color;
 
 out vec2 tex_coord;
+flat out float layer;
+flat out vec4 color;
 
 void main()
 {
-    gl_Position = vec4(origin, 0.0, 0.0) + ortho * vec4(vertex.xy, 0.0, 1.0);
-    tex_coord = vertex.zw;
+    gl_Position = ortho * vec4(g_pos + vertex.xy * g_size, 0.0, 1.0);
+    tex_coord = mix(g_uv.xy, g_uv.zw, vertex.zw);
+    layer = g_layer;
+    color = g_color;
 }
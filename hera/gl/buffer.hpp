@@ -109,7 +109,50 @@ public:
         else {
             throw gl_error("attempt to draw null vertex buffer");
         }
-        unbind();
+    }
+
+    // attaches instances of T stored in `buf` from byte `offset` onwards.
+    template<typename T>
+        requires is_vertex<T>
+    void instances(id::buffer buf, GLintptr offset, GLuint first) const
+    {
+        gl::bind(vao());
+        gl::bind(buf, buffer_t::array);
+        for (const auto& attr : vertex<T>::format) {
+            glVertexAttribPointer(first + attr.index, attr.size, attr.type,
+                                  GL_FALSE, attr.stride,
+                                  (GLvoid*)(offset + attr.offset));
+            glEnableVertexAttribArray(first + attr.index);
+            glVertexAttribDivisor(first + attr.index, 1);
+        }
+        gl::unbind(buffer_t::array);
+    }
+
+    // draws `count` instances of the buffer contents.
+    void draw(GLsizei count, primitive_t mode = primitive_t::triangles) const
+    {
+        bind();
+        if (ebo_type) {
+            gl::draw_instanced(mode, ebo_count, ebo_type, count);
+        }
+        else if (vbo_count != 0) {
+            gl::draw_instanced(mode, vbo_count, count);
+        }
+        else {
+            throw gl_error("attempt to draw null vertex buffer");
+        }
+    }
+
+    // draws `count` instances of the `n` indices starting at index `first`.
+    void draw_range(GLsizei first, GLsizei n, GLsizei count = 1,
+                    primitive_t mode = primitive_t::triangles) const
+    {
+        if (!ebo_type) {
+            throw gl_error("attempt to draw range of unindexed buffer");
+        }
+        bind();
+        gl::draw_instanced(mode, n, ebo_type, count,
+                           size_t(first) * gl_sizeof(+ebo_type));
     }
 };
 
@@ -934,11 +934,25 @@ constexpr bool gl_valid(const T& value)
         HERA_MAKE_VALIDS_K(HERA_GL_ENUMS)
 }
 
+namespace detail {
+// set once a KHR_debug callback reports errors as they occur.
+inline bool debug_output = false;
+// call site of the latest checkerror, reported with debug messages.
+inline std::source_location last_check;
+} // namespace detail
+
 // logs any GL errors and returns the last error code in the error log.
+//
+// with debug output active errors are reported by the callback, so this only
+// records a checkpoint. release builds compile it away.
 inline void
 checkerror(std::source_location loc = std::source_location::current())
 {
     if constexpr (HERA_DEBUG) {
+        if (detail::debug_output) {
+            detail::last_check = loc;
+            return;
+        }
         error_t err;
         auto func = loc.function_name();
         auto file = loc.file_name();
@@ -0,0 +1,207 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstring>
+
+#include <hera/gl/debug.hpp>
+
+namespace hera::gl {
+
+namespace {
+// glad is generated without KHR_debug, so its tokens and entry points are
+// declared here.
+constexpr GLenum debug_output = 0x92E0;
+constexpr GLenum debug_output_synchronous = 0x8242;
+constexpr GLenum context_flag_debug_bit = 0x0002;
+
+constexpr GLenum source_api = 0x8246;
+constexpr GLenum source_window_system = 0x8247;
+constexpr GLenum source_shader_compiler = 0x8248;
+constexpr GLenum source_third_party = 0x8249;
+constexpr GLenum source_application = 0x824A;
+
+constexpr GLenum type_error = 0x824C;
+constexpr GLenum type_deprecated = 0x824D;
+constexpr GLenum type_undefined = 0x824E;
+constexpr GLenum type_portability = 0x824F;
+constexpr GLenum type_performance = 0x8250;
+constexpr GLenum type_marker = 0x8268;
+constexpr GLenum type_push_group = 0x8269;
+constexpr GLenum type_pop_group = 0x826A;
+
+constexpr GLenum severity_high = 0x9146;
+constexpr GLenum severity_medium = 0x9147;
+constexpr GLenum severity_low = 0x9148;
+constexpr GLenum severity_notification = 0x826B;
+
+struct {
+    void(GLAD_API_PTR* message_callback)(GLDEBUGPROC, const void*) = nullptr;
+    void(GLAD_API_PTR* message_control)(GLenum, GLenum, GLenum, GLsizei,
+                                        const GLuint*, GLboolean) = nullptr;
+    void(GLAD_API_PTR* object_label)(GLenum, GLuint, GLsizei,
+                                     const GLchar*) = nullptr;
+    void(GLAD_API_PTR* push_group)(GLenum, GLuint, GLsizei,
+                                   const GLchar*) = nullptr;
+    void(GLAD_API_PTR* pop_group)() = nullptr;
+} khr;
+
+// names of the open debug groups, innermost last.
+vector<string> groups;
+
+template<typename F>
+bool load(F& fn, const char* name)
+{
+    fn = reinterpret_cast<F>(glfwGetProcAddress(name));
+    return fn != nullptr;
+}
+
+constexpr string_view source_str(GLenum source)
+{
+    switch (source) {
+    case source_api:
+        return "api";
+    case source_window_system:
+        return "window system";
+    case source_shader_compiler:
+        return "shader compiler";
+    case source_third_party:
+        return "third party";
+    case source_application:
+        return "application";
+    default:
+        return "other";
+    }
+}
+
+constexpr string_view type_str(GLenum type)
+{
+    switch (type) {
+    case type_error:
+        return "error";
+    case type_deprecated:
+        return "deprecated";
+    case type_undefined:
+        return "undefined behavior";
+    case type_portability:
+        return "portability";
+    case type_performance:
+        return "performance";
+    case type_marker:
+        return "marker";
+    default:
+        return "other";
+    }
+}
+
+void GLAD_API_PTR on_message(GLenum source, GLenum type, GLuint id,
+                             GLenum severity, GLsizei length,
+                             const GLchar* message, const void*)
+{
+    if (type == type_push_group || type == type_pop_group) {
+        return;
+    }
+    string_view text{message, length < 0 ? std::strlen(message)
+                                         : static_cast<size_t>(length)};
+    string_view group = groups.empty() ? "-" : groups.back();
+    // messages are synchronous, so the last checkpoint precedes the call.
+    const auto& loc = detail::last_check;
+    auto src = source_str(source);
+    auto ty = type_str(type);
+    auto func = loc.function_name();
+    auto file = loc.file_name();
+    auto line = loc.line();
+    switch (severity) {
+    case severity_high:
+        LOG_ERROR("GL {} {} {}: {} [in {}, after {}:{}:{}]", src, ty, id,
+                  text, group, func, file, line);
+        break;
+    case severity_medium:
+        LOG_WARNING("GL {} {} {}: {} [in {}, after {}:{}:{}]", src, ty, id,
+                    text, group, func, file, line);
+        break;
+    case severity_low:
+        LOG_INFO("GL {} {} {}: {} [in {}, after {}:{}:{}]", src, ty, id,
+                 text, group, func, file, line);
+        break;
+    default:
+        LOG_DEBUG("GL {} {} {}: {} [in {}, after {}:{}:{}]", src, ty, id,
+                  text, group, func, file, line);
+        break;
+    }
+}
+} // namespace
+
+bool debug_init()
+{
+    if (!glfwExtensionSupported("GL_KHR_debug")) {
+        LOG_INFO("GL_KHR_debug unavailable, polling glGetError");
+        return false;
+    }
+    bool loaded = load(khr.message_callback, "glDebugMessageCallback") &&
+                  load(khr.message_control, "glDebugMessageControl") &&
+                  load(khr.object_label, "glObjectLabel") &&
+                  load(khr.push_group, "glPushDebugGroup") &&
+                  load(khr.pop_group, "glPopDebugGroup");
+    if (!loaded) {
+        LOG_WARNING("GL_KHR_debug advertised but not loadable");
+        khr = {};
+        return false;
+    }
+
+    if constexpr (HERA_DEBUG) {
+        if (!(gl::get<GLint>(GL_CONTEXT_FLAGS) & context_flag_debug_bit)) {
+            LOG_WARNING("not a debug context, GL messages may be sparse");
+        }
+        glEnable(debug_output);
+        glEnable(debug_output_synchronous);
+        khr.message_control(GL_DONT_CARE, GL_DONT_CARE, severity_notification,
+                            0, nullptr, GL_FALSE);
+        khr.message_callback(on_message, nullptr);
+        detail::debug_output = true;
+        LOG_DEBUG("GL debug output enabled");
+    }
+    return true;
+}
+
+bool debug_available()
+{
+    return khr.object_label != nullptr;
+}
+
+void label(GLenum identifier, GLuint name, string_view label)
+{
+    if (khr.object_label) {
+        khr.object_label(identifier, name, label.size(), label.data());
+    }
+}
+
+debug_group::debug_group(string_view name)
+{
+    if (khr.push_group) {
+        khr.push_group(source_application, 0, name.size(), name.data());
+        groups.emplace_back(name);
+    }
+}
+
+debug_group::~debug_group()
+{
+    if (khr.pop_group) {
+        khr.pop_group();
+        groups.pop_back();
+    }
+}
+
+} // namespace hera::gl
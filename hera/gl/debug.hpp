@@ -0,0 +1,50 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_GL_DEBUG_HPP
+#define HERA_GL_DEBUG_HPP
+
+#include <hera/common.hpp>
+#include <hera/gl/common.hpp>
+
+namespace hera::gl {
+
+// loads GL_KHR_debug if the context supports it. debug builds also route
+// debug messages to the log, replacing glGetError polling.
+//
+// returns false if the extension is unavailable.
+bool debug_init();
+
+// whether GL_KHR_debug was loaded.
+bool debug_available();
+
+// names an object in debuggers and debug messages. `identifier` is the
+// KHR_debug namespace of `name`, which must have been bound at least once.
+void label(GLenum identifier, GLuint name, string_view label);
+
+// a named region of commands, shown in debuggers and debug messages.
+class debug_group {
+public:
+    explicit debug_group(string_view name);
+    ~debug_group();
+
+    debug_group(const debug_group&) = delete;
+    debug_group& operator=(const debug_group&) = delete;
+};
+
+} // namespace hera::gl
+
+#endif
@@ -16,6 +16,8 @@
 
 #include <hera/common.hpp>
 #include <hera/gl/common.hpp>
+#include <hera/gl/object.hpp>
+#include <hera/gl/debug.hpp>
 #include <hera/init.hpp>
 #include <hera/error.hpp>
 
@@ -27,6 +29,7 @@ void init::gl()
     if (!gladLoadGL(glfwGetProcAddress)) {
         throw hera::runtime_error("failed to initialize GLAD");
     }
+    gl::debug_init();
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -40,4 +43,58 @@ void init::gl()
     LOG_DEBUG("init GL done");
 }
 
+namespace gl {
+
+void state_cache::invalidate()
+{
+    _unit = unknown;
+    for (auto& unit : _textures) {
+        unit.fill(unknown);
+    }
+    _buffers.fill(unknown);
+    _varray = unknown;
+    _pipeline = unknown;
+}
+
+bool state_cache::validate() const
+{
+    using detail::binding;
+    bool ok = true;
+    auto check = [&](bind_query query, GLuint cached) {
+        if (cached == unknown) {
+            return;
+        }
+        if (auto have = binding<GLuint>(query); have != cached) {
+            LOG_ERROR("GL state mismatch: {} is {}, cached {}",
+                      gl_str(+query), have, cached);
+            ok = false;
+        }
+    };
+
+    if (_unit != unknown) {
+        check(bind_query::active_texture, _unit + GL_TEXTURE0);
+    }
+    check(bind_query::vertex_array, _varray);
+    check(bind_query::pipeline, _pipeline);
+    for (size_t i = 0; i < n_buffers; ++i) {
+        check(detail::to_bind_query(detail::buffer_targets[i]), _buffers[i]);
+    }
+
+    auto active = binding<GLenum>(bind_query::active_texture);
+    for (size_t u = 0; u < max_units; ++u) {
+        const auto& unit = _textures[u];
+        if (ranges::all_of(unit, [](GLuint t) { return t == unknown; })) {
+            continue;
+        }
+        glActiveTexture(GL_TEXTURE0 + u);
+        for (size_t i = 0; i < n_textures; ++i) {
+            check(detail::to_bind_query(detail::texture_targets[i]), unit[i]);
+        }
+    }
+    glActiveTexture(active);
+    return ok;
+}
+
+} // namespace gl
+
 } // namespace hera
@@ -22,6 +22,7 @@
 #include <hera/error.hpp>
 #include <hera/utility.hpp>
 #include <hera/gl/vertex.hpp>
+#include <hera/gl/debug.hpp>
 
 namespace hera::gl {
 
@@ -87,8 +88,207 @@ inline T binding(bind_query query)
     glGetIntegerv(+query, &store);
     return static_cast<T>(store);
 }
+
+// texture targets with their own binding point in each unit.
+inline constexpr texture_t texture_targets[] = {
+    texture_t::oneD,           texture_t::twoD,
+    texture_t::threeD,         texture_t::array_1d,
+    texture_t::array_2d,       texture_t::rectangle,
+    texture_t::cube_map,       texture_t::buffer,
+    texture_t::multisample_2d, texture_t::multisample_2d_array,
+};
+
+// buffer targets with a binding query, the copy targets have none.
+inline constexpr buffer_t buffer_targets[] = {
+    buffer_t::array,      buffer_t::element_array,
+    buffer_t::pixel_pack, buffer_t::pixel_unpack,
+    buffer_t::texture,    buffer_t::transform_feedback,
+    buffer_t::uniform,
+};
+
+// index of the target in its table, or the table size if untracked.
+constexpr size_t target_index(texture_t t)
+{
+    auto it = ranges::find(texture_targets, t);
+    return it - ranges::begin(texture_targets);
+}
+
+constexpr size_t target_index(buffer_t b)
+{
+    auto it = ranges::find(buffer_targets, b);
+    return it - ranges::begin(buffer_targets);
+}
 } // namespace detail
 
+// shadow of the context's bindings, so redundant binds can be skipped.
+//
+// every bind in hera::gl goes through the cache. code binding objects behind
+// its back (e.g. imgui) must call `invalidate()` afterwards. there is a single
+// context, so there is a single cache.
+class state_cache {
+public:
+    // a binding that must be issued before it can be trusted.
+    static constexpr GLuint unknown = ~GLuint{0};
+    // texture units tracked, binds to higher units are always issued.
+    static constexpr size_t max_units = 32;
+
+    struct stats {
+        size_t issued = 0;
+        size_t elided = 0;
+    };
+
+private:
+    static constexpr size_t n_textures = std::size(detail::texture_targets);
+    static constexpr size_t n_buffers = std::size(detail::buffer_targets);
+
+    GLuint _unit;
+    array<array<GLuint, n_textures>, max_units> _textures;
+    array<GLuint, n_buffers> _buffers;
+    GLuint _varray;
+    GLuint _pipeline;
+    stats _stats;
+
+public:
+    state_cache() { invalidate(); }
+
+    // forgets all bindings.
+    void invalidate();
+
+    // compares every known binding against the context, logging mismatches.
+    //
+    // returns false on a mismatch.
+    bool validate() const;
+
+    // records an object deletion, which unbinds it from the context.
+    template<id::id T>
+    void forget(span<const GLuint> ids);
+
+    // the following record a binding, returning false if it is redundant.
+
+    bool unit(GLuint u)
+    {
+        if (_unit == u) {
+            return elide(bind_query::active_texture, u + GL_TEXTURE0);
+        }
+        _unit = u;
+        return issue();
+    }
+
+    bool texture(texture_t tgt, GLuint tex)
+    {
+        auto i = detail::target_index(tgt);
+        if (_unit >= max_units || i >= n_textures) {
+            return issue();
+        }
+        auto& slot = _textures[_unit][i];
+        if (slot == tex) {
+            return elide(detail::to_bind_query(tgt), tex);
+        }
+        slot = tex;
+        return issue();
+    }
+
+    bool buffer(buffer_t tgt, GLuint buf)
+    {
+        auto i = detail::target_index(tgt);
+        if (i >= n_buffers) {
+            return issue();
+        }
+        if (_buffers[i] == buf) {
+            return elide(detail::to_bind_query(tgt), buf);
+        }
+        _buffers[i] = buf;
+        return issue();
+    }
+
+    // indexed binds also replace the generic binding, but are not elided.
+    void buffer_indexed(buffer_t tgt, GLuint buf)
+    {
+        auto i = detail::target_index(tgt);
+        if (i < n_buffers) {
+            _buffers[i] = buf;
+        }
+        issue();
+    }
+
+    bool varray(GLuint v)
+    {
+        if (_varray == v) {
+            return elide(bind_query::vertex_array, v);
+        }
+        _varray = v;
+        // the element array binding belongs to the vertex array.
+        _buffers[detail::target_index(buffer_t::element_array)] = unknown;
+        return issue();
+    }
+
+    bool pipeline(GLuint p)
+    {
+        if (_pipeline == p) {
+            return elide(bind_query::pipeline, p);
+        }
+        _pipeline = p;
+        return issue();
+    }
+
+    const stats& counters() const { return _stats; }
+    void reset_counters() { _stats = {}; }
+
+private:
+    bool issue()
+    {
+        ++_stats.issued;
+        return true;
+    }
+
+    // HERA_CHECK_GL_STATE builds check the skipped bind against the context,
+    // at the cost of a query per bind.
+    bool elide(bind_query query, GLuint expect)
+    {
+        ++_stats.elided;
+        if constexpr (HERA_CHECK_GL_STATE) {
+            if (auto have = detail::binding<GLuint>(query); have != expect) {
+                LOG_ERROR("stale GL state: {} is {}, cached {}",
+                          gl_str(+query), have, expect);
+                invalidate();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// the binding state of the current context.
+inline state_cache& state()
+{
+    static state_cache cache;
+    return cache;
+}
+
+template<id::id T>
+void state_cache::forget(span<const GLuint> ids)
+{
+    auto reset = [&](GLuint& slot) {
+        if (ranges::contains(ids, slot)) {
+            slot = 0;
+        }
+    };
+    if constexpr (same_as<T, id::buffer>) {
+        ranges::for_each(_buffers, reset);
+    }
+    else if constexpr (same_as<T, id::texture>) {
+        for (auto& unit : _textures) {
+            ranges::for_each(unit, reset);
+        }
+    }
+    else if constexpr (same_as<T, id::varray>) {
+        reset(_varray);
+    }
+    else if constexpr (same_as<T, id::pipeline>) {
+        reset(_pipeline);
+    }
+}
+
 // returns the currently bound object.
 template<typename T>
 inline T current()
@@ -143,13 +343,19 @@ template<typename T>
 inline void unbind()
 {
     if constexpr (same_as<T, texture_u>) {
-        glActiveTexture(GL_TEXTURE0);
+        if (state().unit(0)) {
+            glActiveTexture(GL_TEXTURE0);
+        }
     }
     else if constexpr (same_as<T, id::varray>) {
-        glBindVertexArray(0);
+        if (state().varray(0)) {
+            glBindVertexArray(0);
+        }
     }
     else if constexpr (same_as<T, id::pipeline>) {
-        glBindProgramPipeline(0);
+        if (state().pipeline(0)) {
+            glBindProgramPipeline(0);
+        }
     }
     else if constexpr (same_as<T, id::framebuffer>) {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -164,17 +370,22 @@ inline void unbind()
 // unbinds the buffer target.
 inline void unbind(buffer_t tgt)
 {
-    glBindBuffer(+tgt, 0);
+    if (state().buffer(tgt, 0)) {
+        glBindBuffer(+tgt, 0);
+    }
 }
 // unbinds the indexed buffer target.
 inline void unbind(buffer_t tgt, GLuint index)
 {
+    state().buffer_indexed(tgt, 0);
     glBindBufferBase(+tgt, index, 0);
 }
 // unbinds the texture target.
 inline void unbind(texture_t tgt)
 {
-    glBindTexture(+tgt, 0);
+    if (state().texture(tgt, 0)) {
+        glBindTexture(+tgt, 0);
+    }
 }
 // unbinds the framebuffer target.
 inline void unbind(framebuffer_t tgt)
@@ -185,38 +396,50 @@ inline void unbind(framebuffer_t tgt)
 // activates the texture unit.
 inline void bind(texture_u unit)
 {
-    glActiveTexture(unit.offset());
+    if (state().unit(+unit)) {
+        glActiveTexture(unit.offset());
+    }
 }
 // binds the vertex array object.
 inline void bind(id::varray v)
 {
-    glBindVertexArray(v);
+    if (state().varray(v)) {
+        glBindVertexArray(v);
+    }
 }
 // binds the buffer object to the target.
 inline void bind(id::buffer buf, buffer_t tgt)
 {
-    glBindBuffer(+tgt, buf);
+    if (state().buffer(tgt, buf)) {
+        glBindBuffer(+tgt, buf);
+    }
 }
 // binds the buffer object to the indexed target.
 inline void bind(id::buffer buf, buffer_t tgt, GLuint index)
 {
+    state().buffer_indexed(tgt, buf);
     glBindBufferBase(+tgt, index, buf);
 }
 // binds a range within a buffer to the indexed target.
 inline void bind(id::buffer buf, buffer_t tgt, GLuint index, GLintptr offset,
                  GLsizeiptr size)
 {
+    state().buffer_indexed(tgt, buf);
     glBindBufferRange(+tgt, index, buf, offset, size);
 }
 // binds the texture object to the target.
 inline void bind(id::texture tex, texture_t tgt)
 {
-    glBindTexture(+tgt, tex);
+    if (state().texture(tgt, tex)) {
+        glBindTexture(+tgt, tex);
+    }
 }
 // binds the pipeline object.
 inline void bind(id::pipeline pipe)
 {
-    glBindProgramPipeline(pipe);
+    if (state().pipeline(pipe)) {
+        glBindProgramPipeline(pipe);
+    }
 }
 // binds the framebuffer object to both read and write targets.
 inline void bind(id::framebuffer fb)
@@ -245,6 +468,8 @@ struct object_traits<id::varray> {
         glDeleteVertexArrays(n, src);
     }
     static constexpr string_view name = "vertex array";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = 0x8074;
 };
 
 template<>
@@ -252,6 +477,8 @@ struct object_traits<id::buffer> {
     static void generate(int n, GLuint* dst) { glGenBuffers(n, dst); }
     static void destroy(int n, const GLuint* src) { glDeleteBuffers(n, src); }
     static constexpr string_view name = "buffer";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = 0x82E0;
 };
 
 template<>
@@ -259,6 +486,8 @@ struct object_traits<id::texture> {
     static void generate(int n, GLuint* dst) { glGenTextures(n, dst); }
     static void destroy(int n, const GLuint* src) { glDeleteTextures(n, src); }
     static constexpr string_view name = "texture";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = GL_TEXTURE;
 };
 
 template<>
@@ -269,6 +498,8 @@ struct object_traits<id::pipeline> {
         glDeleteProgramPipelines(n, src);
     }
     static constexpr string_view name = "pipeline";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = 0x82E4;
 };
 
 template<>
@@ -282,6 +513,8 @@ struct object_traits<id::program> {
         std::for_each_n(src, n, glDeleteProgram);
     }
     static constexpr string_view name = "program";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = 0x82E2;
 };
 
 template<>
@@ -292,6 +525,8 @@ struct object_traits<id::framebuffer> {
         glDeleteFramebuffers(n, src);
     }
     static constexpr string_view name = "framebuffer";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = GL_FRAMEBUFFER;
 };
 
 template<>
@@ -302,10 +537,19 @@ struct object_traits<id::renderbuffer> {
         glDeleteRenderbuffers(n, src);
     }
     static constexpr string_view name = "renderbuffer";
+    // KHR_debug object namespace.
+    static constexpr GLenum identifier = GL_RENDERBUFFER;
 };
 
 // generic operations for all objects
 
+// names the object in debuggers and debug messages.
+template<id::id T>
+void label(T obj, string_view name)
+{
+    label(object_traits<T>::identifier, obj, name);
+}
+
 template<typename T>
 concept generatable =
     requires(int n, GLuint* dst) { object_traits<T>::generate(n, dst); };
@@ -342,6 +586,7 @@ void destroy(R& src_r)
     auto n = ranges::size(src_r);
 
     object_traits<T>::destroy(n, src);
+    state().forget<T>(span{src, n});
 
     string_view plural = (n > 1 ? "s" : "");
     LOG_TRACE_L2("glDel {}{}: {}", object_traits<T>::name, plural,
@@ -521,6 +766,15 @@ void allocate(texture_t tgt, internal_f internalf, int w, int h,
                  ranges::cdata(pixels));
 }
 
+// 2D texture allocation from the bound pixel unpack buffer.
+inline void allocate(texture_t tgt, internal_f internalf, int w, int h,
+                     GLintptr offset, pixel_f pixelf, pixel_t pixelty)
+{
+    assert(gl_dimensions(tgt) == 2);
+    glTexImage2D(+tgt, 0, +internalf, w, h, 0, +pixelf, +pixelty,
+                 reinterpret_cast<const void*>(offset));
+}
+
 // 3D texture allocation with data.
 template<spanner R>
     requires gl_type<range_v<R>>
@@ -750,6 +1004,19 @@ inline void draw(primitive_t mode, GLsizei count, gl_t type, size_t offset = 0)
     glDrawElements(+mode, count, +type, (const void*)offset); // NOLINT
 }
 
+inline void draw_instanced(primitive_t mode, GLsizei count, GLsizei instances,
+                           GLint start = 0)
+{
+    glDrawArraysInstanced(+mode, start, count, instances);
+}
+
+inline void draw_instanced(primitive_t mode, GLsizei count, gl_t type,
+                           GLsizei instances, size_t offset = 0)
+{
+    glDrawElementsInstanced(+mode, count, +type, (const void*)offset, // NOLINT
+                            instances);
+}
+
 // set the value of a uniform variable.
 template<uniformable U>
 void uniform(id::program p, GLint loc, const U& v)
@@ -1078,6 +1345,29 @@ public:
         return reinterpret_cast<const type&>(v.id_data[I]);
     }
 
+    // labels every ID, suffixing the type and index when there are several.
+    //
+    // objects must have been bound before they can be labelled.
+    void label(string_view name) const
+    {
+        if (!debug_available()) {
+            return;
+        }
+        auto labelfn = [&]<id::id T>(span<const T> ids) {
+            for (size_t i = 0; i < ids.size(); ++i) {
+                if (size() == 1) {
+                    gl::label(ids[i], name);
+                }
+                else {
+                    gl::label(ids[i],
+                              fmt::format("{}:{}[{}]", name,
+                                          object_traits<T>::name, i));
+                }
+            }
+        };
+        (labelfn(span<const decltype(IDs)>{get<decltype(IDs)>()}), ...);
+    }
+
     void swap(object& other) noexcept
     {
         rc.swap(other.rc);
@@ -31,6 +31,13 @@ string Preprocessor::preprocess(const string& src,
                                 const defines_map& local_defines) const
 {
     string buf;
+    // #version must come first, so defines go after it.
+    size_t body = 0;
+    if (src.starts_with("#version")) {
+        body = src.find('\n');
+        body = body == src.npos ? src.size() : body + 1;
+        buf.append(src, 0, body);
+    }
     auto output = back_inserter(buf);
     for (auto&& [k, v] : _defines) {
         std::format_to(output, "#define {} {}\n", k, v);
@@ -39,7 +46,7 @@ string Preprocessor::preprocess(const string& src,
         std::format_to(output, "#define {} {}\n", k, v);
     }
 
-    buf.append(src);
+    buf.append(src, body);
     return buf;
 }
 
@@ -91,6 +98,12 @@ Shader::Shader(path pat)
         throw gl_error("indeterminate shader type");
     }
     gl::parameter(id(), GL_PROGRAM_SEPARABLE, true);
+    label(_fname.native());
+}
+
+Shader::Shader(path pat, span<const unsigned char> blob) : Shader{std::move(pat)}
+{
+    _blob = blob;
 }
 
 void Shader::update_link_log() const
@@ -138,7 +151,12 @@ void Shader::update_compilation_log(GLuint sID) const
 
 void Shader::read()
 {
-    _source = slurp(_fpath);
+    if (!_blob.empty()) {
+        _source.assign(_blob.begin(), _blob.end());
+    }
+    else {
+        _source = slurp(_fpath);
+    }
 }
 
 void Shader::index_fnames()
@@ -313,6 +331,34 @@ void Pipeline::attach(const Shader& sh)
     gl::attach(id(), sh.id(), sh.type());
 }
 
+void Pipeline::resolve() const
+{
+    for (auto& slot : _slots) {
+        if (!resolve_slot(slot)) {
+            LOG_WARNING("uniform lost on reload: {}:{}", name(), slot.name);
+        }
+    }
+}
+
+bool Pipeline::resolve_slot(uniform_slot& slot) const
+{
+    slot.vloc = _vert.locate(slot.name, slot.type, slot.size).value_or(-1);
+    slot.floc = _frag.locate(slot.name, slot.type, slot.size).value_or(-1);
+    return slot.vloc != -1 || slot.floc != -1;
+}
+
+void Pipeline::report_missing(string_view tyname, string_view uname) const
+{
+    // hashed so that repeated misses don't allocate.
+    size_t key = 0;
+    boost::hash_combine(key, tyname);
+    boost::hash_combine(key, name());
+    boost::hash_combine(key, uname);
+    if (_missing.insert(key).second) {
+        LOG_ERROR("uniform doesn't exist: {} {}:{}", tyname, name(), uname);
+    }
+}
+
 string Pipeline::info_log() const
 {
     auto len = gl::parameter(id(), GL_INFO_LOG_LENGTH);
@@ -334,10 +380,10 @@ void Shaders::define(const string& key, const string& value)
     _preprocessor.define(key, value);
 }
 
-const Shader& Shaders::loadf(const path& pat)
+const Shader& Shaders::loadf(const path& pat, span<const unsigned char> blob)
 {
     // if it already exists, call load again.
-    auto&& sh = _shaders.emplace(pat.native(), pat).first->second;
+    auto&& sh = _shaders.try_emplace(pat.native(), pat, blob).first->second;
     sh.load(*this);
     auto blk_info = sh.build_cache();
     for (auto&& [bname, binfo] : blk_info) {
@@ -383,6 +429,39 @@ void Shaders::load(const path& pat)
         auto& it = touched.insert({sh.modname(), {}}).first->second;
         it.push_back(&sh);
     }
+    link_modules(touched);
+}
+
+void Shaders::load(const hera::link& dir)
+{
+    const path pat = dir.resolve();
+    vector<pair<path, span<const unsigned char>>> packed;
+    for (auto&& name : dir.list()) {
+        auto file = dir;
+        file.append(name);
+        auto bytes = file.view();
+        if (!bytes) {
+            // not packed, read the directory from disk.
+            return load(pat);
+        }
+        if (Shader::classify(name).valid()) {
+            packed.emplace_back(pat / name, *bytes);
+        }
+    }
+    LOG_DEBUG("loading {} packed shaders: {}", packed.size(), dir);
+    // modname -> shaders
+    hash_map<string_view, vector<const Shader*>> touched;
+    for (auto&& [fpath, bytes] : packed) {
+        auto& sh = loadf(fpath, bytes);
+        bind_blocks_to(sh);
+        touched[sh.modname()].push_back(&sh);
+    }
+    link_modules(touched);
+}
+
+void Shaders::link_modules(
+    const hash_map<string_view, vector<const Shader*>>& touched)
+{
     for (const auto& [modname, shaders] : touched) {
         auto n = shaders.size();
         if (n == 1) {
@@ -396,6 +475,7 @@ void Shaders::load(const path& pat)
         for (auto sh : shaders) {
             pipe.attach(*sh);
         }
+        pipe.label(modname);
     }
 }
 
@@ -403,9 +483,64 @@ void Shaders::load()
 {
     for (auto& sh : views::values(_shaders)) {
         sh.load(*this);
+        sh.build_cache();
+        // relinking resets block bindings.
+        bind_blocks_to(sh);
+    }
+    // pipelines hold copies of their stages, refresh them before resolving.
+    for (auto& pipe : views::values(_pipelines)) {
+        for (Shader* stage : {&pipe._vert, &pipe._frag}) {
+            if (*stage) {
+                *stage = _shaders.at(stage->_fpath.native());
+            }
+        }
+        pipe.resolve();
     }
 }
 
+size_t Shaders::reload(const path& file)
+{
+    const auto target = file.lexically_normal();
+    hash_set<string> reloaded;
+    for (auto& sh : views::values(_shaders)) {
+        const auto fpath = sh._fpath.lexically_normal();
+        bool depends = fpath == target;
+        for (const auto& inc : sh._fname_indices) {
+            depends = depends || (fpath.parent_path() / inc) == target;
+        }
+        if (!depends) {
+            continue;
+        }
+        if (fpath == target) {
+            // the file on disk supersedes any packed copy.
+            sh._blob = {};
+        }
+        try {
+            sh.load(*this);
+        }
+        catch (const gl_error&) {
+            LOG_WARNING("keeping previous shader: {}", sh.filename());
+        }
+        // a failed compile leaves the old program linked.
+        sh.build_cache();
+        bind_blocks_to(sh);
+        reloaded.insert(sh._fpath.native());
+    }
+    for (auto& pipe : views::values(_pipelines)) {
+        bool stale = false;
+        for (Shader* stage : {&pipe._vert, &pipe._frag}) {
+            if (*stage && reloaded.contains(stage->_fpath.native())) {
+                *stage = _shaders.at(stage->_fpath.native());
+                stale = true;
+            }
+        }
+        if (stale) {
+            pipe.resolve();
+        }
+    }
+    return reloaded.size();
+}
+
 const Pipeline& Shaders::active() const
 {
     return *_active;
@@ -418,12 +553,26 @@ const Pipeline& Shaders::active(string_view name)
         LOG_CRITICAL("active() with non-existent program: {}", name);
         throw gl_error("non-existent program");
     }
-    auto&& program = elt->second;
+    return active(elt->second);
+}
+
+const Pipeline& Shaders::active(const Pipeline& program)
+{
     program.bind();
     _active = &program;
     return program;
 }
 
+const Pipeline& Shaders::pipeline(string_view name) const
+{
+    auto elt = _pipelines.find(name);
+    if (elt == _pipelines.end()) {
+        LOG_CRITICAL("pipeline() with non-existent program: {}", name);
+        throw gl_error("non-existent program");
+    }
+    return elt->second;
+}
+
 void Shaders::bind_block(const UniformBuffer<>& buf) const
 {
     for (auto&& [pat, sh] : _shaders) {
@@ -20,6 +20,7 @@
 #include <hera/common.hpp>
 #include <hera/gl/common.hpp>
 #include <hera/gl/object.hpp>
+#include <hera/io/link.hpp>
 #include <utility>
 
 namespace hera::gl {
@@ -44,6 +45,8 @@ class Shader : private object<id::program(1)> {
     shader_t _type;
     string _modname;
     string _source;
+    // source bytes in a mapped archive, read instead of `_fpath` if set.
+    span<const unsigned char> _blob;
     // #line directives use integers not filenames.
     // this mapping keeps error messages comprehensible.
     vector<string> _fname_indices;
@@ -65,6 +68,8 @@ class Shader : private object<id::program(1)> {
 
 public:
     explicit Shader(path pat);
+    // a shader whose source is already in memory, named by `pat`.
+    Shader(path pat, span<const unsigned char> blob);
 
     static const Shader null;
 
@@ -77,7 +82,7 @@ public:
     void define(const string& key, const string& value = "");
     // read, preprocess, compile and link.
     void load(const Shaders&);
-    // read file into source buffer.
+    // read file (or blob) into source buffer.
     void read();
     // preprocess source buffer.
     void preprocess(const Preprocessor&);
@@ -91,20 +96,26 @@ public:
     bool is_null() const { return id() == 0; }
     explicit operator bool() const { return !is_null(); }
 
-    template<uniformable T>
-    optional<int> has_uniform(string_view name, const T& v) const
+    // location of a uniform of compatible type and size.
+    optional<int> locate(string_view name, GLenum type, GLint size) const
     {
-        using value_type = uniform_traits<T>::value_type;
         if (auto it = _uniforms.find(name); it != _uniforms.cend()) {
-            auto&& [loc, type, size] = it->second;
-            if (compatible_uniform(type, gl_typeof<value_type>()) &&
-                size == uniform_size(v) && loc != -1) {
+            auto&& [loc, utype, usize] = it->second;
+            if (compatible_uniform(utype, type) && usize == size &&
+                loc != -1) {
                 return loc;
             }
         }
         return nullopt;
     }
 
+    template<uniformable T>
+    optional<int> has_uniform(string_view name, const T& v) const
+    {
+        using value_type = uniform_traits<T>::value_type;
+        return locate(name, gl_typeof<value_type>(), uniform_size(v));
+    }
+
     template<uniformable T>
     bool uniform(string_view name, const T& v) const
     {
@@ -130,6 +141,7 @@ public:
         std::swap(_fpath, other._fpath);
         std::swap(_fname, other._fname);
         std::swap(_type, other._type);
+        std::swap(_blob, other._blob);
     }
 
 private:
@@ -150,7 +162,10 @@ private:
     static constexpr bool compatible_uniform(GLenum expect, GLenum have)
     {
         bool sampler = (expect == GL_SAMPLER_1D || expect == GL_SAMPLER_2D ||
-                        expect == GL_SAMPLER_2D_ARRAY);
+                        expect == GL_SAMPLER_2D_ARRAY ||
+                        expect == GL_SAMPLER_BUFFER ||
+                        expect == GL_INT_SAMPLER_BUFFER ||
+                        expect == GL_UNSIGNED_INT_SAMPLER_BUFFER);
         return (expect == have) || (sampler && have == GL_INT);
     }
 
@@ -158,13 +173,47 @@ private:
     static string make_modname(const path&);
 };
 
+// a uniform of type T in a pipeline, resolved ahead of time.
+//
+// handles index the slot table of the pipeline that issued them, and remain
+// valid across shader reloads.
+template<uniformable T>
+class UniformHandle {
+    static constexpr uint32_t invalid = ~0u;
+    uint32_t _slot = invalid;
+
+    explicit UniformHandle(uint32_t slot) : _slot{slot} {}
+
+    friend class Pipeline;
+
+public:
+    UniformHandle() = default;
+
+    bool valid() const { return _slot != invalid; }
+    explicit operator bool() const { return valid(); }
+};
+
 class Pipeline : private object<id::pipeline(1)> {
-    inline static hash_set<string> _missing;
+    // hashes of {type, pipeline, uniform} already reported missing.
+    inline static hash_set<size_t> _missing;
     static constexpr id::pipeline pipeID{0};
     string _name;
     Shader _vert = Shader::null;
     Shader _frag = Shader::null;
 
+    // a resolved uniform. locations are -1 in stages that lack it.
+    struct uniform_slot {
+        string name;
+        GLenum type;
+        GLint size;
+        GLint vloc = -1;
+        GLint floc = -1;
+    };
+
+    mutable vector<uniform_slot> _slots;
+
+    friend class Shaders;
+
 public:
     explicit Pipeline(nullptr_t) : object{nullptr}, _name{"null"} {};
     explicit Pipeline(string_view name) : _name{name} {};
@@ -184,6 +233,46 @@ public:
     bool validate() const;
     string_view name() const { return _name; }
 
+    // resolves a handle to the uniform `uname` holding `size` elements.
+    template<uniformable T>
+    UniformHandle<T> resolve(string_view uname, GLint size = 1) const
+    {
+        using value_type = uniform_traits<T>::value_type;
+        constexpr GLenum type = gl_typeof<value_type>();
+        for (uint32_t i = 0; i < _slots.size(); ++i) {
+            const auto& slot = _slots[i];
+            if (slot.name == uname && slot.type == type && slot.size == size) {
+                return UniformHandle<T>{i};
+            }
+        }
+        auto& slot = _slots.emplace_back(string{uname}, type, size);
+        if (!resolve_slot(slot)) {
+            report_missing(type_of<T>(), uname);
+        }
+        return UniformHandle<T>{static_cast<uint32_t>(_slots.size() - 1)};
+    }
+
+    // re-resolves all handles, e.g. after the stages are relinked.
+    void resolve() const;
+
+    // sets a uniform through a handle issued by this pipeline.
+    template<uniformable T>
+    void uniform(UniformHandle<T> h, const T& v) const
+    {
+        assert(h.valid() && h._slot < _slots.size());
+        const auto& slot = _slots[h._slot];
+        if (slot.vloc != -1) {
+            gl::uniform(_vert.id(), slot.vloc, v);
+        }
+        if (slot.floc != -1) {
+            gl::uniform(_frag.id(), slot.floc, v);
+        }
+    }
+
+    // sets a uniform by name.
+    //
+    // this hashes the name in both stages on every call; prefer handles for
+    // anything set per frame.
     template<uniformable T>
     void uniform(string_view uname, const T& v) const
     {
@@ -197,18 +286,21 @@ public:
             _frag.uniform(*loc, v);
         }
         if (!hit) {
-            auto&& [_, first_miss] = _missing.emplace(
-                fmt::format("{} {}:{}", type_of<T>(), name(), uname));
-            if (first_miss) {
-                LOG_ERROR("uniform doesn't exist: {} {}:{}", type_of<T>(),
-                          name(), uname);
-            }
+            report_missing(type_of<T>(), uname);
         }
     }
 
     decltype(auto) vert(this auto& self) { return self._vert; }
     decltype(auto) frag(this auto& self) { return self._frag; }
 
+private:
+    // returns false if no stage has the uniform.
+    bool resolve_slot(uniform_slot&) const;
+    // logs a missing uniform once.
+    void report_missing(string_view tyname, string_view uname) const;
+
+public:
+
     template<size_t I>
     decltype(auto) get(this auto& self)
     {
@@ -257,10 +349,14 @@ struct payload_of_t<T> : mat<gl_cols<T>(), 4, typename T::value_type> {};
 template<gl_vector T>
 struct payload_of_t<T> : std::conditional<gl_length(T{}) == 3, vec4, T> {};
 
-// provides unique block binding points for each buffer.
-static GLuint next_block_binding = 0;
+// provides unique block binding points for each buffer. inline, so every
+// translation unit draws from the same counter.
+inline GLuint next_block_binding = 0;
 } // namespace detail
 
+// a uniform block of the members Ts.
+//
+// writes go to a std140 CPU mirror and `flush` uploads the changed bytes.
 template<glsl_type... Ts>
 class UniformBuffer : object<id::buffer{1}> {
     static constexpr id::buffer uboID{0};
@@ -281,22 +377,33 @@ class UniformBuffer : object<id::buffer{1}> {
     template<size_t I>
     using element_at = std::tuple_element_t<I, UniformBuffer>;
 
+    static constexpr size_t block_bytes = sizeof(tuple<gl_aligned<Ts>...>);
+
 public:
     constexpr id::buffer id() const { return get<uboID>(); }
     static consteval size_t size() { return sizeof...(Ts); }
-    static consteval size_t size_bytes()
-    {
-        return sizeof(tuple<gl_aligned<Ts>...>);
-    }
+    static consteval size_t size_bytes() { return block_bytes; }
+
+    using block_type = array<std::byte, block_bytes>;
+
+private:
+    alignas(16) block_type _shadow{};
+    // changed bytes of the mirror, empty when lo >= hi.
+    size_t _dirty_lo = block_bytes;
+    size_t _dirty_hi = 0;
+
+public:
 
     UniformBuffer(string_view name)
         : _block_binding{detail::next_block_binding++},
           _name{name}
     {
         gl::bind(id(), uniform);
-        // allocate the buffer.
-        gl::allocate(uniform, size_bytes(), buffer_use::static_draw);
+        // allocate the buffer, zeroed like the mirror.
+        glBufferData(+uniform, size_bytes(), _shadow.data(),
+                     +buffer_use::dynamic_draw);
         gl::bind(id(), uniform, _block_binding);
+        label(_name);
     }
 
     string_view name() const { return _name; }
@@ -313,27 +420,187 @@ public:
     // returns the block index for this buffer
     GLuint binding() const { return _block_binding; }
 
+    // the std140 representation of member I.
+    //
+    // vec3s keep their 12 bytes, so a following scalar may share the slot.
     template<size_t I>
-    void write(const element_at<I>& val)
+    static constexpr auto encode(const element_at<I>& val)
     {
         using elt_t = element_at<I>;
-
-        bind();
-        if constexpr (same_as<elt_t, payload_of<elt_t>>) {
-            static_assert(sizeof(val) == gl_size<elt_t>());
-            gl::data(uniform, offset_at<I>, views::single(val));
-        }
-        else if constexpr (same_as<elt_t, vec3>) {
-            payload_of<elt_t> payload = glm::make_vec4(val);
+        if constexpr (gl_matrix<elt_t>) {
+            payload_of<elt_t> payload{val};
             static_assert(sizeof(payload) == gl_size<elt_t>());
-            gl::data(uniform, offset_at<I>, views::single(payload));
+            return std::bit_cast<array<std::byte, sizeof(payload)>>(payload);
         }
         else {
-            payload_of<elt_t> payload{val};
-            static_assert(sizeof(payload) == gl_size<elt_t>());
-            gl::data(uniform, offset_at<I>, views::single(payload));
+            return std::bit_cast<array<std::byte, sizeof(elt_t)>>(val);
         }
     }
+
+    // the std140 image of a block holding `vals`.
+    static constexpr block_type pack(const Ts&... vals)
+    {
+        block_type block{};
+        auto members = std::forward_as_tuple(vals...);
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (ranges::copy(encode<I>(std::get<I>(members)),
+                          block.begin() + offset_at<I>),
+             ...);
+        }(std::index_sequence_for<Ts...>{});
+        return block;
+    }
+
+    template<size_t I>
+    void write(const element_at<I>& val)
+    {
+        auto bytes = encode<I>(val);
+        auto dst = span{_shadow}.subspan(offset_at<I>, bytes.size());
+        if (ranges::equal(bytes, dst)) {
+            return;
+        }
+        ranges::copy(bytes, dst.begin());
+        mark(offset_at<I>, offset_at<I> + bytes.size());
+    }
+
+    // replaces every member.
+    void write_all(const Ts&... vals)
+    {
+        _shadow = pack(vals...);
+        mark(0, size_bytes());
+    }
+
+    bool dirty() const { return _dirty_lo < _dirty_hi; }
+
+    // uploads the changed bytes in one call, spanning every write since the
+    // last flush.
+    void flush()
+    {
+        if (!dirty()) {
+            return;
+        }
+        bind();
+        glBufferSubData(+uniform, _dirty_lo, _dirty_hi - _dirty_lo,
+                        _shadow.data() + _dirty_lo);
+        _dirty_lo = block_bytes;
+        _dirty_hi = 0;
+    }
+
+private:
+    void mark(size_t lo, size_t hi)
+    {
+        _dirty_lo = std::min(_dirty_lo, lo);
+        _dirty_hi = std::max(_dirty_hi, hi);
+    }
+};
+
+// specialize to describe the members of a struct used in uniform blocks.
+template<typename T>
+struct block_struct;
+
+// base type for block_struct<T> specializations to inherit from.
+//
+// members are restricted to 16-byte aligned types without padding, so the
+// C++ layout of the struct is its std140 layout.
+template<glsl_type... Ts>
+    requires((gl_alignof<Ts>() == 16 && sizeof(Ts) == gl_size<Ts>()) && ...)
+struct members {
+    static constexpr size_t size = sizeof...(Ts);
+    static constexpr size_t size_bytes = (sizeof(Ts) + ...);
+    static constexpr array<GLenum, sizeof...(Ts)> types = {gl_typeof<Ts>()...};
+};
+
+// specifies a type may be used as a struct in a std140 uniform block.
+template<typename T>
+concept std140_struct =
+    std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T> &&
+    requires {
+        block_struct<T>::types;
+        block_struct<T>::size_bytes;
+    } && sizeof(T) == block_struct<T>::size_bytes;
+
+// a uniform block holding an array of structs.
+//
+//   layout(std140) uniform Name { T name[N]; };
+//
+// writes go to a CPU mirror and `flush` uploads only the changed elements.
+template<std140_struct T>
+class UniformArray : object<id::buffer{1}> {
+    static constexpr id::buffer uboID{0};
+    using buffer_t::uniform;
+    friend class UniformBuffer<>;
+
+    GLuint _block_binding;
+    string _name;
+    vector<T> _mirror;
+    vector<bool> _dirty;
+    bool _any_dirty = false;
+
+public:
+    using value_type = T;
+
+    UniformArray(string_view name, size_t n)
+        : _block_binding{detail::next_block_binding++},
+          _name{name},
+          _mirror(n),
+          _dirty(n, false)
+    {
+        gl::bind(id(), uniform);
+        gl::allocate(uniform, size_bytes(), buffer_use::dynamic_draw);
+        glBufferSubData(+uniform, 0, size_bytes(), _mirror.data());
+        gl::bind(id(), uniform, _block_binding);
+        label(_name);
+    }
+
+    constexpr id::buffer id() const { return get<uboID>(); }
+    string_view name() const { return _name; }
+    size_t size() const { return _mirror.size(); }
+    size_t size_bytes() const { return hera::size_bytes(_mirror); }
+
+    void bind() const { gl::bind(id(), uniform); }
+
+    void bind_to(const Shader& prog) const
+    {
+        auto idx = glGetUniformBlockIndex(prog.id(), _name.c_str());
+        glUniformBlockBinding(prog.id(), idx, _block_binding);
+    }
+
+    GLuint binding() const { return _block_binding; }
+
+    const T& operator[](size_t i) const { return _mirror[i]; }
+
+    // marks element `i` changed and returns it for writing.
+    T& edit(size_t i)
+    {
+        _dirty[i] = _any_dirty = true;
+        return _mirror[i];
+    }
+
+    void set(size_t i, const T& v) { edit(i) = v; }
+
+    bool dirty() const { return _any_dirty; }
+
+    // uploads each run of changed elements.
+    void flush()
+    {
+        if (!_any_dirty) {
+            return;
+        }
+        bind();
+        for (size_t i = 0, n = size(); i < n;) {
+            if (!_dirty[i]) {
+                ++i;
+                continue;
+            }
+            size_t j = i;
+            while (j < n && _dirty[j]) {
+                _dirty[j++] = false;
+            }
+            glBufferSubData(+uniform, i * sizeof(T), (j - i) * sizeof(T),
+                            &_mirror[i]);
+            i = j;
+        }
+        _any_dirty = false;
+    }
 };
 
 // type-erased uniform buffer.
@@ -356,6 +623,12 @@ public:
           _block_binding{concrete._block_binding},
           _name{concrete._name} {};
 
+    template<std140_struct T>
+    UniformBuffer(const UniformArray<T>& concrete)
+        : object{concrete},
+          _block_binding{concrete._block_binding},
+          _name{concrete._name} {};
+
     constexpr id::buffer id() const { return get<uboID>(); }
 
     string_view name() const { return _name; }
@@ -427,10 +700,18 @@ public:
     // shader files which share a filename stem are considered a "module"
     // and will be linked together into a pipeline of the same name.
     void load(const path&);
+    // as above, compiling straight from an archive when the directory is
+    // packed.
+    void load(const hera::link&);
 
     // reloads existing shaders
     void load();
 
+    // reloads only the shaders built from `file` and relinks the pipelines
+    // using them, returning how many were reloaded. a shader that fails to
+    // compile keeps its previous program.
+    size_t reload(const path& file);
+
     // links the shaders of module `name` into a program.
     void link(string_view name);
 
@@ -467,10 +748,51 @@ public:
         bind_block(blk->second);
     }
 
+    template<std140_struct T>
+    void add_block(const UniformArray<T>& buf)
+    {
+        auto binfo = _block_infos.find(buf.name());
+        if (binfo == _block_infos.end()) {
+            LOG_CRITICAL("uniform block missing: {}", buf.name());
+            throw hera::runtime_error("missing uniform block");
+        }
+        auto&& [size, types] = binfo->second;
+        if (size_t(size) != buf.size_bytes()) {
+            LOG_CRITICAL(
+                "uniform block size mismatch: {}: expect: {}, got: {}",
+                buf.name(), size, buf.size_bytes());
+            throw hera::runtime_error("mismatched uniform block size");
+        }
+        // the members of every element, in order.
+        constexpr auto& elt_types = block_struct<T>::types;
+        if (types.size() != buf.size() * elt_types.size()) {
+            LOG_CRITICAL(
+                "uniform block length mismatch: {}: expect: {}, got: {}",
+                buf.name(), types.size(), buf.size() * elt_types.size());
+            throw hera::runtime_error("mismatched uniform block length");
+        }
+        for (size_t i = 0; i < types.size(); ++i) {
+            auto expect_ty = types[i];
+            auto given_ty = elt_types[i % elt_types.size()];
+            if (expect_ty != given_ty) {
+                LOG_CRITICAL("uniform block type mismatch: expect: {}, got: {}",
+                             expect_ty, given_ty);
+                throw hera::runtime_error("uniform block type mismatch");
+            }
+        }
+        const auto& blk =
+            _blocks.emplace(buf.name(), UniformBuffer<>(buf)).first;
+        bind_block(blk->second);
+    }
+
     // returns the active pipeline.
     const Pipeline& active() const;
     // sets the active pipeline and returns it.
     const Pipeline& active(string_view name);
+    // sets the active pipeline.
+    const Pipeline& active(const Pipeline&);
+    // returns the named pipeline without binding it.
+    const Pipeline& pipeline(string_view name) const;
 
 private:
     // binds a uniform buffer to all programs that want it.
@@ -478,7 +800,9 @@ private:
     // binds all contained uniform buffers to a given program.
     void bind_blocks_to(const Shader&) const;
     // loads and compiles a single shader file
-    const Shader& loadf(const path&);
+    const Shader& loadf(const path&, span<const unsigned char> blob = {});
+    // links the loaded shaders of each module into pipelines.
+    void link_modules(const hash_map<string_view, vector<const Shader*>>&);
 };
 } // namespace hera::gl
 
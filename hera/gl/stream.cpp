@@ -0,0 +1,148 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <hera/gl/stream.hpp>
+
+namespace hera::gl {
+
+namespace detail {
+buffer_storage_fn buffer_storage()
+{
+    static buffer_storage_fn fn = [] -> buffer_storage_fn {
+        if (!glfwExtensionSupported("GL_ARB_buffer_storage")) {
+            LOG_INFO("GL_ARB_buffer_storage unavailable, mapping buffers "
+                     "unsynchronized instead of persistently");
+            return nullptr;
+        }
+        return reinterpret_cast<buffer_storage_fn>(
+            glfwGetProcAddress("glBufferStorage"));
+    }();
+    return fn;
+}
+} // namespace detail
+
+namespace {
+// `align` must be a power of two.
+constexpr uint64_t align_up(uint64_t v, uint64_t align)
+{
+    return (v + align - 1) & ~(align - 1);
+}
+} // namespace
+
+StreamBuffer::StreamBuffer(size_t capacity) : _capacity{capacity}
+{
+    constexpr auto tgt = buffer_t::copy_write;
+    gl::bind(buffer(), tgt);
+    if (auto storage = detail::buffer_storage()) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | detail::map_persistent_bit |
+                           detail::map_coherent_bit;
+        storage(+tgt, _capacity, nullptr, flags);
+        _persistent = static_cast<std::byte*>(
+            glMapBufferRange(+tgt, 0, _capacity, flags));
+    }
+    else {
+        gl::allocate(tgt, _capacity, buffer_use::stream_draw);
+    }
+    gl::unbind(tgt);
+    label("stream buffer");
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (const auto& f : _fences) {
+        glDeleteSync(f.sync);
+    }
+}
+
+StreamBuffer::range StreamBuffer::allocate(size_t bytes, size_t align)
+{
+    assert(!_mapped && "previous range was not committed");
+
+    uint64_t pos = align_up(_head, align);
+    if (pos % _capacity + bytes > _capacity) {
+        // ranges never straddle the end of the ring. the capacity needn't be
+        // a power of two, so no mask here.
+        pos = (pos + _capacity - 1) / _capacity * _capacity;
+    }
+    if (pos + bytes - _frame_start > _capacity) {
+        LOG_ERROR("stream buffer overflow: {} bytes this frame, capacity {}",
+                  pos + bytes - _frame_start, _capacity);
+        throw gl_error("stream buffer overflow");
+    }
+    // wait for in-flight frames whose data would be overwritten.
+    while (!_fences.empty() && _fences.front().start + _capacity < pos + bytes) {
+        wait(_fences.front());
+        _fences.pop_front();
+    }
+    _head = pos + bytes;
+    _stats.bytes += bytes;
+
+    GLintptr offset = pos % _capacity;
+    std::byte* ptr;
+    if (_persistent) {
+        ptr = _persistent + offset;
+    }
+    else {
+        constexpr auto tgt = buffer_t::copy_write;
+        gl::bind(buffer(), tgt);
+        ptr = static_cast<std::byte*>(glMapBufferRange(
+            +tgt, offset, bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                GL_MAP_UNSYNCHRONIZED_BIT));
+        _mapped = true;
+    }
+    return {ptr, offset, static_cast<GLsizeiptr>(bytes)};
+}
+
+void StreamBuffer::commit(const range&)
+{
+    // coherent persistent mappings need no flush.
+    if (_mapped) {
+        constexpr auto tgt = buffer_t::copy_write;
+        gl::bind(buffer(), tgt);
+        glUnmapBuffer(+tgt);
+        _mapped = false;
+    }
+}
+
+void StreamBuffer::end_frame()
+{
+    if (_head != _frame_start) {
+        _fences.push_back(
+            {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), _frame_start});
+        _frame_start = _head;
+    }
+    _last = std::exchange(_stats, {});
+}
+
+void StreamBuffer::wait(const fence& f)
+{
+    GLenum status = glClientWaitSync(f.sync, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        ++_stats.waits;
+        do {
+            // 1ms, flushing so the fence is guaranteed to signal.
+            status = glClientWaitSync(f.sync, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                      1'000'000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    if (status == GL_WAIT_FAILED) {
+        LOG_ERROR("stream buffer fence wait failed");
+    }
+    glDeleteSync(f.sync);
+}
+
+} // namespace hera::gl
@@ -0,0 +1,128 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_GL_STREAM_HPP
+#define HERA_GL_STREAM_HPP
+
+#include <cstring>
+#include <deque>
+
+#include <hera/common.hpp>
+#include <hera/gl/object.hpp>
+
+namespace hera::gl {
+
+namespace detail {
+// GL_ARB_buffer_storage, which glad is generated without.
+inline constexpr GLbitfield map_persistent_bit = 0x0040;
+inline constexpr GLbitfield map_coherent_bit = 0x0080;
+
+using buffer_storage_fn = void(GLAD_API_PTR*)(GLenum, GLsizeiptr,
+                                              const void*, GLbitfield);
+
+// glBufferStorage, or null without GL_ARB_buffer_storage.
+buffer_storage_fn buffer_storage();
+} // namespace detail
+
+// a ring of transient GPU data written straight into mapped memory.
+//
+// ranges are handed out front to back and wrap around. each frame's ranges
+// are fenced at `end_frame`, and a range only waits on the GPU if it would
+// overwrite a frame still in flight. with GL_ARB_buffer_storage the buffer
+// is mapped once, persistently. otherwise each range is mapped unsynchronized
+// and must be committed before it is drawn from.
+class StreamBuffer : object<id::buffer{1}> {
+public:
+    static constexpr id::buffer bufID{0};
+
+    // a writable range of the ring.
+    struct range {
+        std::byte* ptr;
+        GLintptr offset;
+        GLsizeiptr size;
+
+        template<typename T>
+        span<T> as() const
+        {
+            return {reinterpret_cast<T*>(ptr), size / sizeof(T)};
+        }
+    };
+
+    struct stats {
+        size_t bytes = 0;
+        // allocations that had to wait for the GPU.
+        size_t waits = 0;
+    };
+
+private:
+    struct fence {
+        GLsync sync;
+        // ring position of the first byte of the frame.
+        uint64_t start;
+    };
+
+    size_t _capacity;
+    // bytes handed out so far, offsets are taken modulo the capacity.
+    uint64_t _head = 0;
+    uint64_t _frame_start = 0;
+    std::deque<fence> _fences;
+    // base of the persistent mapping, if any.
+    std::byte* _persistent = nullptr;
+    bool _mapped = false;
+    stats _stats;
+    stats _last;
+
+public:
+    explicit StreamBuffer(size_t capacity);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    id::buffer buffer() const { return get<bufID>(); }
+    size_t capacity() const { return _capacity; }
+    bool persistent() const { return _persistent != nullptr; }
+
+    // reserves `bytes` aligned to `align`, which must be a power of two.
+    range allocate(size_t bytes, size_t align = 16);
+
+    // makes a written range visible to the GPU.
+    void commit(const range& r);
+
+    // copies `data` into the ring and returns its offset.
+    template<spanner R>
+    GLintptr write(const R& data, size_t align = 16)
+    {
+        auto bytes = size_bytes(data);
+        auto r = allocate(bytes, align);
+        std::memcpy(r.ptr, ranges::cdata(data), bytes);
+        commit(r);
+        return r.offset;
+    }
+
+    // fences the ranges handed out since the last call.
+    void end_frame();
+
+    // counters of the previous frame.
+    const stats& last_stats() const { return _last; }
+
+private:
+    void wait(const fence& f);
+};
+
+} // namespace hera::gl
+
+#endif
@@ -16,10 +16,10 @@
 
 #include <hera/io/image.hpp>
 #include <hera/gl/texture.hpp>
+#include <hera/gl/upload.hpp>
 
 namespace hera::gl {
 
-namespace {
 internal_f channels_to_format(int channels)
 {
     switch (channels) {
@@ -35,35 +35,73 @@ internal_f channels_to_format(int channels)
         throw gl_error{"bad texture image channel number"};
     }
 }
-} // namespace
 
 Texture2d::Texture2d(const link& fpath, const TextureParams& params,
                      texture_u unit)
     : Texture{unit}
 {
     auto img = assets::get<image_data>(fpath);
-    internal_f format = channels_to_format(img->channels);
+    uploader().upload(*this, *img, params);
+    label(fmt::format("{}", fpath));
+    if (assets::drop_uploaded_images()) {
+        assets::erase<image_data>(fpath);
+    }
+}
 
-    bind();
-    params.apply(target);
-    gl::allocate(target, format, img->size.x, img->size.y, **img);
+Texture2d Texture2d::load_async(const link& fpath,
+                                const TextureParams& params, texture_u unit)
+{
+    static constexpr array<unsigned char, 4> grey{128, 128, 128, 255};
 
+    Texture2d tex{unit};
+    tex.bind();
+    params.apply(target);
+    gl::allocate(target, internal_f::rgba, 1, 1, grey);
     glGenerateMipmap(+target);
+    tex.label(fmt::format("{}", fpath));
+
+    // copies share the texture name, so every holder sees the upload. the
+    // pixels are staged on the loader thread, leaving the main thread only
+    // the call that defines the texture from them.
+    auto staged = std::make_shared<optional<TextureUploader::staged>>();
+    assets::get_async<image_data>(
+        fpath,
+        [tex, params, fpath, staged](const auto& img) {
+            uploader().upload(tex, *img, params, std::move(*staged));
+            if (assets::drop_uploaded_images()) {
+                assets::erase<image_data>(fpath);
+            }
+        },
+        [staged](const auto& img) {
+            *staged = TextureUploader::stage(*img);
+        });
+    return tex;
 }
 
 void Texture2d::allocate(const image_data& data, const TextureParams& params)
 {
-    bind();
-    params.apply(target);
-    gl::allocate(target, channels_to_format(data.channels), data.size.x,
-                 data.size.y, *data);
-    glGenerateMipmap(+target);
+    uploader().upload(*this, data, params);
 }
 
 void Texture2d::allocate(const link& pat, const TextureParams& params)
 {
     auto img = assets::get<image_data>(pat);
     allocate(*img, params);
+    if (assets::drop_uploaded_images()) {
+        assets::erase<image_data>(pat);
+    }
 }
 
 } // namespace hera::gl
+
+namespace hera {
+
+shared_ptr<gl::Texture2d> asset<gl::Texture2d>::load_from(const link& pat)
+{
+    // each image is staged on a loader thread and uploaded by its own
+    // finalize job, so loading a model doesn't upload every texture at once.
+    return std::make_shared<gl::Texture2d>(gl::Texture2d::load_async(
+        pat, gl::TextureParams{.min_filter = GL_LINEAR_MIPMAP_LINEAR}));
+}
+
+} // namespace hera
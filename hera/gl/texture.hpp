@@ -67,7 +67,6 @@ struct Texture : object<id::texture(1)> {
         }
         gl::bind(_unit);
         gl::bind(id(), target);
-        gl::checkerror();
     }
 
     void unbind() const { gl::unbind(target); }
@@ -136,16 +135,73 @@ struct TextureArray : Texture<texture_t::array_2d> {
     }
 };
 
+// a texture viewing the contents of a buffer object.
+struct TextureBuffer : Texture<texture_t::buffer> {
+    static constexpr id::buffer bufID{0};
+
+    object<id::buffer{1}> storage;
+    internal_f iformat;
+
+    TextureBuffer(internal_f internalf, texture_u unit = 0)
+        : Texture{unit},
+          iformat{internalf}
+    {
+        gl::bind(buffer(), buffer_t::texture);
+        gl::allocate(buffer_t::texture, 16, buffer_use::stream_draw);
+        gl::unbind(buffer_t::texture);
+        bind();
+        glTexBuffer(+target, +iformat, buffer());
+    }
+
+    id::buffer buffer() const { return storage.get<bufID>(); }
+
+    // replaces the buffer contents, orphaning the previous storage.
+    template<spanner R>
+        requires gl_type<range_v<R>> || glsl_type<range_v<R>>
+    void data(const R& texels) const
+    {
+        gl::bind(buffer(), buffer_t::texture);
+        gl::allocate(buffer_t::texture, texels, buffer_use::stream_draw);
+        gl::unbind(buffer_t::texture);
+    }
+};
+
+// internal format of an image with `channels` 8-bit channels.
+internal_f channels_to_format(int channels);
+
 struct Texture2d : Texture<texture_t::twoD> {
     using Texture::Texture;
 
     Texture2d(const link& fpath, const TextureParams& params = {},
               texture_u unit = 0);
 
+    // a grey placeholder whose image is decoded in the background and
+    // uploaded in place once ready.
+    static Texture2d load_async(const link& fpath,
+                                const TextureParams& params = {},
+                                texture_u unit = 0);
+
+    // uploads through the staging ring of the renderer, see
+    // `TextureUploader`. the mipmaps follow once the transfer completes.
     void allocate(const image_data&, const TextureParams& = {});
     void allocate(const link&, const TextureParams& = {});
 };
 
 } // namespace hera::gl
 
+namespace hera {
+
+// mipmapped textures shared by everything that links the same image. the
+// cache holds them weakly, so they're freed with their last user. loads
+// must run on the main thread, and return a placeholder until the image has
+// loaded, see `Texture2d::load_async`.
+template<>
+struct asset<gl::Texture2d> {
+    using weak_storage = void;
+
+    shared_ptr<gl::Texture2d> load_from(const link&);
+};
+
+} // namespace hera
+
 #endif
@@ -0,0 +1,246 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstring>
+
+#include <hera/gl/stream.hpp>
+#include <hera/gl/upload.hpp>
+
+namespace hera::gl {
+
+namespace {
+// the uploader loader threads stage into, guarded against its destruction.
+shared_mutex live_mutex;
+TextureUploader* live = nullptr;
+} // namespace
+
+TextureUploader::staged::~staged()
+{
+    if (!_owner) {
+        return;
+    }
+    shared_lock lk{live_mutex};
+    if (live == _owner) {
+        _owner->release(_pos);
+    }
+}
+
+TextureUploader::TextureUploader(size_t capacity) : _capacity{capacity}
+{
+    if (auto storage = detail::buffer_storage()) {
+        constexpr auto tgt = buffer_t::pixel_unpack;
+        GLbitfield flags = GL_MAP_WRITE_BIT | detail::map_persistent_bit |
+                           detail::map_coherent_bit;
+        gl::bind(buffer(), tgt);
+        storage(+tgt, _capacity, nullptr, flags);
+        _mapped = static_cast<std::byte*>(
+            glMapBufferRange(+tgt, 0, _capacity, flags));
+        gl::unbind(tgt);
+    }
+    _storage.label("texture staging");
+
+    scoped_lock lk{live_mutex};
+    live = this;
+}
+
+TextureUploader::~TextureUploader()
+{
+    {
+        // wakes up stages waiting for room.
+        scoped_lock lk{_mutex};
+        _closing = true;
+    }
+    _room.notify_all();
+    {
+        // waits out any copy into the mapping.
+        scoped_lock lk{live_mutex};
+        if (live == this) {
+            live = nullptr;
+        }
+    }
+    for (const auto& p : _pending) {
+        glDeleteSync(p.fence);
+    }
+}
+
+optional<TextureUploader::staged>
+TextureUploader::stage(const image_data& img)
+{
+    return stage(img, true);
+}
+
+optional<TextureUploader::staged>
+TextureUploader::stage(const image_data& img, bool wait)
+{
+    shared_lock lk{live_mutex};
+    if (!live || !live->_mapped) {
+        return nullopt;
+    }
+    const size_t bytes = img.size_bytes();
+    auto pos = live->reserve(bytes, wait);
+    if (!pos) {
+        return nullopt;
+    }
+    // the range is ours alone, so the copy needs no lock on the ring.
+    std::memcpy(live->_mapped + *pos % live->_capacity, img.buf.get(), bytes);
+    return staged{live, *pos};
+}
+
+void TextureUploader::upload(const Texture2d& tex, const image_data& img,
+                             const TextureParams& params, optional<staged> st)
+{
+    if (st && st->_owner != this) {
+        st.reset();
+    }
+    if (st) {
+        ++_stats.staged;
+    }
+    else {
+        // the main thread frees room, so it mustn't wait for any.
+        st = stage(img, false);
+    }
+    optional<uint64_t> pos;
+    if (st) {
+        // freed by `poll` from here on.
+        pos = st->_pos;
+        st->_owner = nullptr;
+    }
+    else {
+        ++_stats.direct;
+    }
+
+    const internal_f format = channels_to_format(img.channels);
+    tex.bind();
+    params.apply(Texture2d::target);
+    // only the base level exists until `poll` builds the mipmaps.
+    glTexParameteri(+Texture2d::target, GL_TEXTURE_MAX_LEVEL, 0);
+    // tightly packed rows of odd widths break the default alignment.
+    const bool aligned = (img.size.x * img.channels) % 4 == 0;
+    if (!aligned) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+    if (pos) {
+        constexpr auto tgt = buffer_t::pixel_unpack;
+        gl::bind(buffer(), tgt);
+        gl::allocate(Texture2d::target, format, img.size.x, img.size.y,
+                     static_cast<GLintptr>(*pos % _capacity), pixel_f{format},
+                     gl_typeof<uint8_t>());
+        // client pointers mean something else while a pixel buffer is bound.
+        gl::unbind(tgt);
+    }
+    else {
+        gl::allocate(Texture2d::target, format, img.size.x, img.size.y, *img,
+                     pixel_f{format});
+    }
+    if (!aligned) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    _pending.push_back(
+        {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), pos, tex});
+    ++_stats.uploads;
+    _stats.bytes += img.size_bytes();
+}
+
+void TextureUploader::poll()
+{
+    std::erase_if(_pending, [this](const pending& p) {
+        const GLenum status = glClientWaitSync(p.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+        if (status == GL_WAIT_FAILED) {
+            LOG_ERROR("texture staging fence wait failed");
+        }
+        glDeleteSync(p.fence);
+        if (p.pos) {
+            release(*p.pos);
+        }
+        p.tex.bind();
+        // back to the default.
+        glTexParameteri(+Texture2d::target, GL_TEXTURE_MAX_LEVEL, 1000);
+        glGenerateMipmap(+Texture2d::target);
+        return true;
+    });
+}
+
+TextureUploader::stats TextureUploader::counters() const
+{
+    stats st = _stats;
+    st.pending = _pending.size();
+    return st;
+}
+
+optional<uint64_t> TextureUploader::reserve(size_t bytes, bool wait)
+{
+    if (bytes > _capacity) {
+        return nullopt;
+    }
+    unique_lock lk{_mutex};
+    uint64_t pos;
+    auto fits = [&] {
+        pos = (_head + align - 1) & ~(align - 1);
+        if (pos % _capacity + bytes > _capacity) {
+            // images never straddle the end of the ring.
+            pos = (pos + _capacity - 1) / _capacity * _capacity;
+        }
+        if (_slots.empty()) {
+            _tail = pos;
+        }
+        return pos + bytes - _tail <= _capacity;
+    };
+    bool ok = fits();
+    if (!ok && wait) {
+        ok = _room.wait_for(lk, stage_wait,
+                            [&] { return _closing || fits(); }) &&
+             !_closing;
+    }
+    if (!ok) {
+        return nullopt;
+    }
+    _slots.push_back({pos});
+    _head = pos + bytes;
+    return pos;
+}
+
+void TextureUploader::release(uint64_t pos)
+{
+    unique_lock lk{_mutex};
+    auto it = ranges::find_if(
+        _slots, [pos](const slot& s) { return s.pos == pos && !s.done; });
+    if (it == _slots.end()) {
+        return;
+    }
+    it->done = true;
+    // ranges are freed in the order they were reserved.
+    while (!_slots.empty() && _slots.front().done) {
+        _slots.pop_front();
+    }
+    _tail = _slots.empty() ? _head : _slots.front().pos;
+    lk.unlock();
+    _room.notify_all();
+}
+
+TextureUploader& uploader()
+{
+    shared_lock lk{live_mutex};
+    if (!live) {
+        throw gl_error("no texture uploader");
+    }
+    return *live;
+}
+
+} // namespace hera::gl
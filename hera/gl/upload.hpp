@@ -0,0 +1,154 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_GL_UPLOAD_HPP
+#define HERA_GL_UPLOAD_HPP
+
+#include <condition_variable>
+#include <deque>
+
+#include <hera/common.hpp>
+#include <hera/gl/object.hpp>
+#include <hera/gl/texture.hpp>
+
+namespace hera::gl {
+
+// stages texture images through a persistently mapped pixel unpack ring.
+//
+// loader threads copy decoded pixels into the ring with `stage`, and the main
+// thread defines the texture from the staged range, so neither the copy nor
+// the transfer holds up the frame. each upload is fenced, and `poll` builds
+// its mipmaps and frees its range once the transfer has completed. a full
+// ring makes `stage` wait a while for room. images that don't fit in the
+// ring, or every image without GL_ARB_buffer_storage, are defined straight
+// from client memory instead.
+//
+// owned by the renderer, so it's gone before the context is.
+class TextureUploader {
+public:
+    struct stats {
+        size_t uploads = 0;
+        size_t bytes = 0;
+        // uploads staged off the main thread, and those that bypassed the
+        // ring.
+        size_t staged = 0;
+        size_t direct = 0;
+        // uploads waiting on their fence.
+        size_t pending = 0;
+    };
+
+    // pixels copied into the ring and awaiting `upload`. the range is freed
+    // if the handle is dropped unused.
+    class staged {
+        TextureUploader* _owner = nullptr;
+        uint64_t _pos = 0;
+
+        friend class TextureUploader;
+        staged(TextureUploader* owner, uint64_t pos) : _owner{owner}, _pos{pos}
+        {
+        }
+
+    public:
+        staged(staged&& o) noexcept
+            : _owner{std::exchange(o._owner, nullptr)}, _pos{o._pos}
+        {
+        }
+        staged& operator=(staged&& o) noexcept
+        {
+            std::swap(_owner, o._owner);
+            std::swap(_pos, o._pos);
+            return *this;
+        }
+        ~staged();
+    };
+
+private:
+    static constexpr id::buffer bufID{0};
+    // offset alignment of staged images.
+    static constexpr uint64_t align = 256;
+    // longest `stage` waits for room before giving up. bounded, as only the
+    // main thread frees room, and it may itself be waiting on the load.
+    static constexpr milliseconds stage_wait{500};
+
+    struct slot {
+        // ring position of the first byte.
+        uint64_t pos;
+        bool done = false;
+    };
+
+    struct pending {
+        GLsync fence;
+        // ring position of the staged pixels, if staged.
+        optional<uint64_t> pos;
+        Texture2d tex;
+    };
+
+    object<id::buffer{1}> _storage;
+    size_t _capacity;
+    std::byte* _mapped = nullptr;
+
+    // guards the ring bookkeeping, which loader threads reserve from.
+    mutable mutex _mutex;
+    uint64_t _head = 0;
+    // ring position of the oldest byte still in use.
+    uint64_t _tail = 0;
+    std::deque<slot> _slots;
+    // signalled as ranges are freed, and on destruction.
+    std::condition_variable _room;
+    bool _closing = false;
+
+    vector<pending> _pending;
+    stats _stats;
+
+public:
+    explicit TextureUploader(size_t capacity);
+    ~TextureUploader();
+
+    TextureUploader(const TextureUploader&) = delete;
+    TextureUploader& operator=(const TextureUploader&) = delete;
+
+    id::buffer buffer() const { return _storage.get<bufID>(); }
+    size_t capacity() const { return _capacity; }
+
+    // copies `img` into the ring of the live uploader. callable from any
+    // thread. empty without an uploader or persistent mapping, or if no room
+    // frees up in time.
+    static optional<staged> stage(const image_data& img);
+
+    // defines `tex` from `img`, or from its staged copy if given. the
+    // mipmaps follow once the transfer completes. main thread only.
+    void upload(const Texture2d& tex, const image_data& img,
+                const TextureParams& params = {},
+                optional<staged> st = nullopt);
+
+    // builds the mipmaps of completed uploads and frees their ranges.
+    void poll();
+
+    stats counters() const;
+
+private:
+    static optional<staged> stage(const image_data& img, bool wait);
+    // with `wait`, waits up to `stage_wait` for room.
+    optional<uint64_t> reserve(size_t bytes, bool wait);
+    void release(uint64_t pos);
+};
+
+// the uploader of the renderer. throws if there is none.
+TextureUploader& uploader();
+
+} // namespace hera::gl
+
+#endif
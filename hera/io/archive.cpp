@@ -0,0 +1,108 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstring>
+
+#include <hera/error.hpp>
+#include <hera/io/archive.hpp>
+
+namespace hera {
+
+namespace {
+struct header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t names_size;
+};
+
+struct entry {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t name_offset;
+    uint32_t name_size;
+};
+
+static_assert(sizeof(header) == 16 && sizeof(entry) == 24);
+} // namespace
+
+archive::archive(const path& p) : _path{p}, _map{p}
+{
+    auto bytes = _map.bytes();
+    auto malformed = [&](string_view why) {
+        LOG_ERROR("archive {}: {}", _path, why);
+        return runtime_error{"malformed archive"};
+    };
+
+    header hdr;
+    if (bytes.size() < sizeof(hdr)) {
+        throw malformed("truncated header");
+    }
+    std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+    if (hdr.magic != magic || hdr.version != version) {
+        throw malformed("bad magic or version");
+    }
+    const size_t names_at = sizeof(hdr) + size_t(hdr.count) * sizeof(entry);
+    if (bytes.size() < names_at + hdr.names_size) {
+        throw malformed("truncated index");
+    }
+    auto names = string_view{reinterpret_cast<const char*>(bytes.data()),
+                             bytes.size()}
+                     .substr(names_at, hdr.names_size);
+
+    _index.reserve(hdr.count);
+    for (uint32_t i = 0; i != hdr.count; ++i) {
+        entry e;
+        std::memcpy(&e, bytes.data() + sizeof(hdr) + i * sizeof(e),
+                    sizeof(e));
+        if (e.offset % alignment != 0 || e.offset > bytes.size() ||
+            e.size > bytes.size() - e.offset ||
+            size_t(e.name_offset) + e.name_size > names.size()) {
+            throw malformed("entry out of bounds");
+        }
+        _index.emplace(names.substr(e.name_offset, e.name_size),
+                       bytes.subspan(e.offset, e.size));
+    }
+    LOG_DEBUG("archive {}: {} files", _path, _index.size());
+}
+
+optional<span<const unsigned char>> archive::find(string_view name) const
+{
+    if (auto it = _index.find(name); it != _index.end()) {
+        return it->second;
+    }
+    return nullopt;
+}
+
+vector<string_view> archive::list(string_view dir) const
+{
+    vector<string_view> rv;
+    for (string_view name : views::keys(_index)) {
+        if (!dir.empty()) {
+            if (!name.starts_with(dir) || name.size() <= dir.size() ||
+                name[dir.size()] != '/') {
+                continue;
+            }
+            name.remove_prefix(dir.size() + 1);
+        }
+        if (name.find('/') == name.npos) {
+            rv.push_back(name);
+        }
+    }
+    return rv;
+}
+
+} // namespace hera
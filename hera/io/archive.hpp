@@ -0,0 +1,60 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_IO_ARCHIVE_HPP
+#define HERA_IO_ARCHIVE_HPP
+
+#include <hera/common.hpp>
+#include <hera/io/mapped.hpp>
+
+namespace hera {
+
+// a packed asset archive, mapped read-only.
+//
+// written by tools/pack_assets.py. all integers are little-endian:
+//
+//  header:  magic, version, entry count, name table size (u32 each)
+//  entries: {blob offset (u64), blob size (u64), name offset (u32),
+//            name size (u32)} per file
+//  names:   '/'-separated paths relative to the packed directory
+//  blobs:   file contents, each starting on an `alignment` boundary
+class archive {
+public:
+    static constexpr uint32_t magic = 0x4B415048; // "HPAK"
+    static constexpr uint32_t version = 1;
+    static constexpr size_t alignment = 64;
+
+    // maps and indexes `p`, throwing runtime_error if it is malformed.
+    explicit archive(const path& p);
+
+    // contents of the file `name`, viewing the mapping.
+    optional<span<const unsigned char>> find(string_view name) const;
+    // names of the files directly within directory `dir`.
+    vector<string_view> list(string_view dir) const;
+
+    size_t size() const { return _index.size(); }
+    const path& file() const { return _path; }
+
+private:
+    path _path;
+    mapped_file _map;
+    // names view the mapping.
+    hash_map<string_view, span<const unsigned char>> _index;
+};
+
+} // namespace hera
+
+#endif
@@ -0,0 +1,38 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <hera/config.hpp>
+#include <hera/io/assets.hpp>
+
+namespace hera {
+
+void assets::configure(const Config& cfg)
+{
+    constexpr size_t mib = 1024 * 1024;
+
+    auto& budgets = detail::cache_budgets();
+    budgets.clear();
+    const toml::table& tbl = cfg["assets.budget_mb"];
+    tbl.for_each([&](const toml::key& k, const auto& v) {
+        if constexpr (toml::is_number<decltype(v)>) {
+            budgets.insert_or_assign(string{k.str()},
+                                     size_t(v.get()) * mib);
+        }
+    });
+    drop_uploaded() = cfg.at<bool>("assets.drop_uploaded_images");
+}
+
+} // namespace hera
@@ -17,11 +17,19 @@
 #ifndef HERA_LOADER_HPP
 #define HERA_LOADER_HPP
 
+#include <atomic>
+#include <exception>
+#include <future>
+
+#include <oneapi/tbb/task_arena.h>
+
 #include <hera/common.hpp>
 #include <hera/io/link.hpp>
 
 namespace hera {
 
+class Config;
+
 /*
  * specialize and provide a `load_from(const link&)` function.
  */
@@ -66,6 +74,42 @@ using cached_type_t = asset_traits<T>::cached_type;
 template<typename T>
 using storage_type_t = asset_traits<T>::storage_type;
 
+// assets whose decoded size counts against a cache budget.
+template<typename T>
+concept sized_asset = requires(const T& obj) {
+    { obj.size_bytes() } -> std::convertible_to<size_t>;
+};
+
+// assets with a `name` for looking up their own cache budget.
+template<typename T>
+concept named_asset = requires {
+    { asset<T>::name } -> std::convertible_to<string_view>;
+};
+
+namespace detail {
+// byte budgets of the asset caches by asset name, 0 being unlimited.
+// "default" covers unnamed and unlisted types.
+inline hash_map<string, size_t>& cache_budgets()
+{
+    static hash_map<string, size_t> budgets;
+    return budgets;
+}
+} // namespace detail
+
+// counters of one asset type's cache.
+struct cache_stats {
+    size_t hits;
+    size_t misses;
+    // requests that waited on another caller's load.
+    size_t coalesced;
+    // total time spent in loads.
+    duration<float, std::milli> load_time;
+    // resident decoded bytes and the budget they are held to.
+    size_t bytes;
+    size_t budget;
+    size_t evicted;
+};
+
 template<typename T>
     requires asset_type<T>
 class cache {
@@ -76,38 +120,67 @@ public:
     cache() = default;
 
     // retrieves an asset. loads if necessary.
+    //
+    // concurrent misses on the same link share a single load: the first
+    // caller loads while the rest wait on its result.
+    //
+    // once the decoded bytes of sized assets exceed the type's budget, the
+    // least recently used entries nobody else references are dropped.
     cached_type get(const link& pat) const
     {
+        std::shared_future<cached_type> inflight;
+        std::promise<cached_type> promise;
         {
             shared_lock lk{mtx};
-            if (auto elt = storage.find(*pat); elt != storage.end()) {
-                // cache hit
-                if constexpr (weak_asset<T>) {
-                    if (auto obj = elt->second.lock(); obj) {
-                        LOG_DEBUG("cache hit: {}", pat);
-                        return obj;
-                    }
-                    else {
-                        LOG_DEBUG("cache expired: {}", pat);
-                    }
-                }
-                else {
-                    LOG_DEBUG("cache hit: {}", pat);
-                    return elt->second;
-                }
+            if (auto obj = find(pat)) {
+                return *obj;
+            }
+        }
+        {
+            scoped_lock lk{mtx};
+            // someone may have finished loading since the shared lock.
+            if (auto obj = find(pat)) {
+                return *obj;
             }
+            if (auto elt = pending.find(*pat); elt != pending.end()) {
+                inflight = elt->second;
+            }
+            else {
+                pending.emplace(*pat, promise.get_future().share());
+            }
+        }
+        if (inflight.valid()) {
+            LOG_DEBUG("cache wait: {}", pat);
+            ++_coalesced;
+            return inflight.get();
+        }
+
+        // miss, and this caller loads.
+        ++_misses;
+        try {
+            cached_type obj = load_timed(pat);
+            scoped_lock lk{mtx};
+            store(pat, obj);
+            pending.erase(*pat);
+            promise.set_value(obj);
+            return obj;
+        }
+        catch (...) {
+            {
+                scoped_lock lk{mtx};
+                pending.erase(*pat);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
         }
-        // miss
-        return load(pat);
     }
 
     // loads an asset regardless of cache status
     cached_type load(const link& pat) const
     {
-        asset<T> importer;
-        cached_type obj = importer.load_from(pat);
+        cached_type obj = load_timed(pat);
         scoped_lock lk{mtx};
-        storage[*pat] = obj;
+        store(pat, obj);
         return obj;
     }
 
@@ -115,37 +188,395 @@ public:
     void put(const link& pat, cached_type obj)
     {
         scoped_lock lk{mtx};
-        storage[*pat] = std::move(obj);
+        store(pat, std::move(obj));
+    }
+
+    // drops the cached object of `pat`. holders keep their references.
+    void erase(const link& pat) const { erase(*pat); }
+
+    // drops the cached object loaded from `file`, returning whether there
+    // was one.
+    bool erase(const path& file) const
+    {
+        scoped_lock lk{mtx};
+        if (auto elt = storage.find(file); elt != storage.end()) {
+            _bytes -= elt->second.bytes;
+            storage.erase(elt);
+            return true;
+        }
+        return false;
+    }
+
+    cache_stats stats() const
+    {
+        // `_bytes` and `_evicted` are written under the exclusive lock.
+        shared_lock lk{mtx};
+        return {_hits,
+                _misses,
+                _coalesced,
+                chrono::nanoseconds{_load_ns.load()},
+                _bytes,
+                budget(),
+                _evicted};
+    }
+
+    // byte budget of this type from `detail::cache_budgets`.
+    static size_t budget()
+    {
+        const auto& budgets = detail::cache_budgets();
+        if constexpr (named_asset<T>) {
+            if (auto it = budgets.find(asset<T>::name); it != budgets.end()) {
+                return it->second;
+            }
+        }
+        auto it = budgets.find("default");
+        return it != budgets.end() ? it->second : 0;
     }
 
 private:
-    mutable hash_map<path, storage_type> storage;
+    struct entry {
+        storage_type obj;
+        size_t bytes;
+        // `_clock` at the last access.
+        uint64_t used;
+    };
+
+    // cached object of `pat`, if present. needs at least a shared lock.
+    optional<cached_type> find(const link& pat) const
+    {
+        auto elt = storage.find(*pat);
+        if (elt == storage.end()) {
+            return nullopt;
+        }
+        // hits only hold the shared lock.
+        std::atomic_ref{elt->second.used}.store(++_clock,
+                                                std::memory_order_relaxed);
+        if constexpr (weak_asset<T>) {
+            if (auto obj = elt->second.obj.lock(); obj) {
+                LOG_DEBUG("cache hit: {}", pat);
+                ++_hits;
+                return obj;
+            }
+            LOG_DEBUG("cache expired: {}", pat);
+            return nullopt;
+        }
+        else {
+            LOG_DEBUG("cache hit: {}", pat);
+            ++_hits;
+            return elt->second.obj;
+        }
+    }
+
+    static size_t size_of(const cached_type& obj)
+    {
+        if constexpr (sized_asset<T> && !weak_asset<T>) {
+            return obj ? size_t(obj->size_bytes()) : 0;
+        }
+        else {
+            // weak entries don't keep anything resident.
+            return 0;
+        }
+    }
+
+    // inserts or replaces an entry, then trims to budget. needs the unique
+    // lock.
+    void store(const link& pat, cached_type obj) const
+    {
+        const size_t bytes = size_of(obj);
+        auto& e = storage[*pat];
+        _bytes -= e.bytes;
+        _bytes += bytes;
+        e = {std::move(obj), bytes, ++_clock};
+        trim(*pat);
+    }
+
+    // evicts unreferenced entries, oldest first, until under budget.
+    // `keep` is the entry just stored.
+    void trim(const path& keep) const
+    {
+        const size_t limit = budget();
+        if (limit == 0 || _bytes <= limit) {
+            return;
+        }
+        vector<pair<uint64_t, const path*>> victims;
+        for (const auto& [key, e] : storage) {
+            if constexpr (sized_asset<T> && !weak_asset<T>) {
+                // only the cache holds it.
+                if (e.bytes != 0 && e.obj.use_count() == 1 && key != keep) {
+                    victims.emplace_back(e.used, &key);
+                }
+            }
+        }
+        ranges::sort(victims);
+        vector<path> drop;
+        size_t bytes = _bytes;
+        for (const auto& [used, key] : victims) {
+            if (bytes <= limit) {
+                break;
+            }
+            bytes -= storage.find(*key)->second.bytes;
+            drop.push_back(*key);
+        }
+        for (const auto& key : drop) {
+            LOG_DEBUG("cache evict: {}", key);
+            storage.erase(key);
+        }
+        _evicted += drop.size();
+        _bytes = bytes;
+    }
+
+    cached_type load_timed(const link& pat) const
+    {
+        const auto start = clock::now();
+        asset<T> importer;
+        cached_type obj = importer.load_from(pat);
+        _load_ns += duration_cast<chrono::nanoseconds>(clock::now() - start)
+                        .count();
+        return obj;
+    }
+
+    mutable hash_map<path, entry> storage;
+    // loads in progress.
+    mutable hash_map<path, std::shared_future<cached_type>> pending;
     mutable shared_mutex mtx;
+
+    mutable std::atomic<size_t> _hits{0};
+    mutable std::atomic<size_t> _misses{0};
+    mutable std::atomic<size_t> _coalesced{0};
+    mutable std::atomic<int64_t> _load_ns{0};
+    // guarded by the unique lock.
+    mutable size_t _bytes = 0;
+    mutable size_t _evicted = 0;
+    // access order for lru eviction.
+    mutable std::atomic<uint64_t> _clock{0};
+};
+
+namespace detail {
+template<typename T>
+struct async_state {
+    enum class status { loading, ready, failed };
+
+    std::atomic<status> state{status::loading};
+    cached_type_t<T> value{};
+    std::exception_ptr error;
+};
+} // namespace detail
+
+// handle to an asset loading in the background.
+//
+// an asset is ready once its cpu load and main-thread finalization have both
+// run. handles are cheap to copy and share one load.
+template<typename T>
+class asset_handle {
+    using state_type = detail::async_state<T>;
+    using status = state_type::status;
+
+public:
+    using value_type = cached_type_t<T>;
+
+    asset_handle() = default;
+    asset_handle(shared_ptr<state_type> st) : _state{std::move(st)} {}
+
+    bool valid() const { return _state != nullptr; }
+    bool pending() const { return valid() && _state->state == status::loading; }
+    bool ready() const { return valid() && _state->state == status::ready; }
+    bool failed() const { return valid() && _state->state == status::failed; }
+
+    // the loaded asset, rethrowing any load failure. must not be pending.
+    const value_type& get() const
+    {
+        assert(valid() && !pending());
+        if (_state->error) {
+            std::rethrow_exception(_state->error);
+        }
+        return _state->value;
+    }
+
+    // runs finalizers until this load is done, then returns it. main thread
+    // only.
+    const value_type& wait() const;
+
+private:
+    shared_ptr<state_type> _state;
 };
 
 class assets {
 public:
+    template<typename T>
+    using on_ready_fn = function<void(const cached_type_t<T>&)>;
+
     template<typename T>
     static cached_type_t<T> get(const link& pat)
     {
         return get_cache<T>().get(pat);
     }
 
+    // loads an asset on the loader arena. `on_ready` is its gpu finalization
+    // and runs on the main thread from `finalize`. `on_loaded` runs on the
+    // loader thread right after the load, for work that needn't wait on it.
+    template<typename T>
+    static asset_handle<T> get_async(const link& pat,
+                                     on_ready_fn<T> on_ready = {},
+                                     on_ready_fn<T> on_loaded = {})
+    {
+        using state_type = detail::async_state<T>;
+        using status = state_type::status;
+
+        auto st = std::make_shared<state_type>();
+        ++in_flight();
+        arena().enqueue([st, pat, on_ready, on_loaded] {
+            try {
+                st->value = get<T>(pat);
+                if (on_loaded) {
+                    on_loaded(st->value);
+                }
+            }
+            catch (...) {
+                st->error = std::current_exception();
+            }
+            main_queue().push([st, pat, on_ready] {
+                if (!st->error && on_ready) {
+                    try {
+                        on_ready(st->value);
+                    }
+                    catch (...) {
+                        st->error = std::current_exception();
+                    }
+                }
+                if (st->error) {
+                    LOG_ERROR("async load failed: {}", pat);
+                }
+                st->state = st->error ? status::failed : status::ready;
+                --in_flight();
+            });
+        });
+        return st;
+    }
+
     template<typename T>
     static void put(const link& pat, cached_type_t<T> obj)
     {
         get_cache<T>().put(pat, std::move(obj));
     }
 
+    // counters of the cache of `T`.
+    template<typename T>
+    static cache_stats stats()
+    {
+        return get_cache<T>().stats();
+    }
+
+    // drops the cached `T` of `pat`, e.g. once it lives on the gpu.
+    template<typename T>
+    static void erase(const link& pat)
+    {
+        get_cache<T>().erase(pat);
+    }
+
+    // drops every cached asset loaded from `file`, e.g. after it changed on
+    // disk, returning how many were dropped. the next `get` reloads them.
+    static size_t invalidate(const path& file)
+    {
+        size_t n = 0;
+        scoped_lock lk{registry_mutex()};
+        for (const auto& erase : registry()) {
+            n += erase(file);
+        }
+        return n;
+    }
+
+    // reads cache budgets and policies from the `assets` table.
+    static void configure(const Config& cfg);
+
+    // whether decoded images are dropped from the cache once uploaded.
+    static bool drop_uploaded_images() { return drop_uploaded(); }
+
+    // runs queued main-thread finalizers until `budget` is spent, returning
+    // how many ran. at least one runs if any are queued.
+    static size_t finalize(clock::duration budget)
+    {
+        const auto start = clock::now();
+        size_t n = 0;
+        function<void()> job;
+        while (main_queue().try_pop(job)) {
+            job();
+            ++n;
+            if (clock::now() - start >= budget) {
+                break;
+            }
+        }
+        return n;
+    }
+
+    // async loads not yet finalized.
+    static size_t loading() { return in_flight(); }
+
 private:
     template<typename T>
-    static const cache<T>& get_cache()
+    static cache<T>& get_cache()
     {
-        static cache<T> cache{};
-        return cache;
+        // registered with `invalidate` on first use.
+        static cache<T>& instance = [] -> cache<T>& {
+            static cache<T> c{};
+            scoped_lock lk{registry_mutex()};
+            registry().push_back(
+                [](const path& file) { return c.erase(file); });
+            return c;
+        }();
+        return instance;
+    }
+
+    // erasers of every cache in use, for `invalidate`.
+    static vector<bool (*)(const path&)>& registry()
+    {
+        static vector<bool (*)(const path&)> erasers;
+        return erasers;
+    }
+
+    static mutex& registry_mutex()
+    {
+        static mutex mtx;
+        return mtx;
+    }
+
+    // cpu work of async loads, kept off the render thread.
+    static oneapi::tbb::task_arena& arena()
+    {
+        static oneapi::tbb::task_arena arena{
+            int(std::max(std::thread::hardware_concurrency(), 2u) - 1)};
+        return arena;
+    }
+
+    static concurrent_queue<function<void()>>& main_queue()
+    {
+        static concurrent_queue<function<void()>> queue;
+        return queue;
+    }
+
+    static std::atomic<bool>& drop_uploaded()
+    {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    static std::atomic<size_t>& in_flight()
+    {
+        static std::atomic<size_t> count{0};
+        return count;
     }
 };
 
+template<typename T>
+auto asset_handle<T>::wait() const -> const value_type&
+{
+    while (pending()) {
+        if (assets::finalize(clock::duration::max()) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    return get();
+}
+
 } // namespace hera
 
 #endif
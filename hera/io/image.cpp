@@ -28,8 +28,10 @@ cached_type_t<image_data> asset<image_data>::load_from(const link& p)
     // ivec2 size;
     // int channels;
     auto obj = std::make_shared_for_overwrite<image_data>();
-    auto data = stbi_load(p.resolve().c_str(), &obj->size.x, &obj->size.y,
-                          &obj->channels, 0);
+    auto bytes = p.read();
+    auto data = stbi_load_from_memory(bytes.data(), int(bytes.size()),
+                                      &obj->size.x, &obj->size.y,
+                                      &obj->channels, 0);
     if (!data) {
         LOG_ERROR("stbi error: {}", stbi_failure_reason());
         throw runtime_error{"stbi error"};
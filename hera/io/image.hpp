@@ -37,6 +37,8 @@ struct image_data {
 
 template<>
 struct asset<image_data> {
+    static constexpr string_view name = "image";
+
     shared_ptr<image_data> load_from(const link& p);
 };
 
@@ -18,6 +18,7 @@
 #include <hera/error.hpp>
 #include <hera/init.hpp>
 #include <hera/io/link.hpp>
+#include <hera/utility.hpp>
 
 #include <hera/io/router.hpp>
 
@@ -55,27 +56,51 @@ link link::prefix() const
     return result;
 }
 
-const path& link::resolve(bool reload) const
+link link::absolute() const
 {
-    if (!cached.empty() && !reload) {
-        return cached;
-    }
     if (is_complete()) {
-        LOG_DEBUG("resolving complete link: {}", loc.c_str());
-        cached = route_table::resolve(*this);
+        return *this;
     }
     else if (is_relative()) {
-        LOG_DEBUG("resolving relative link: {}", *this);
         auto prelim = prefix();
         prelim.append(loc);
-        cached = route_table::resolve(prelim);
+        return prelim;
     }
     else {
         throw runtime_error{"attempt to resolve invalid link"};
     }
+}
+
+const path& link::resolve(bool reload) const
+{
+    if (!cached.empty() && !reload) {
+        return cached;
+    }
+    LOG_DEBUG("resolving link: {}", *this);
+    cached = route_table::resolve(absolute());
     return cached;
 }
 
+optional<span<const unsigned char>> link::view() const
+{
+    return route_table::view(absolute());
+}
+
+file_bytes link::read() const
+{
+    if (auto bytes = view()) {
+        return file_bytes{*bytes};
+    }
+    vector<unsigned char> buf;
+    slurp(resolve(), buf, ios_base::binary);
+    return file_bytes{std::move(buf)};
+}
+
+vector<string> link::list() const
+{
+    return route_table::list(absolute());
+}
+
 path link::apply(string_view s)
 {
     return link{s}.resolve();
@@ -34,6 +34,29 @@ using urls::url_view_base;
 
 class parts_view;
 
+// the contents of a file, either viewing an archive or read into memory.
+class file_bytes {
+public:
+    file_bytes() noexcept = default;
+    explicit file_bytes(span<const unsigned char> view) noexcept
+        : _bytes{view} {};
+    explicit file_bytes(vector<unsigned char>&& buf) noexcept
+        : _owned{std::move(buf)},
+          _bytes{_owned} {};
+
+    // moving a vector keeps its storage, so `_bytes` stays valid.
+    file_bytes(file_bytes&&) noexcept = default;
+    file_bytes& operator=(file_bytes&&) noexcept = default;
+
+    span<const unsigned char> bytes() const { return _bytes; }
+    const unsigned char* data() const { return _bytes.data(); }
+    size_t size() const { return _bytes.size(); }
+
+private:
+    vector<unsigned char> _owned;
+    span<const unsigned char> _bytes;
+};
+
 /*
  * Types of URLs:
  *
@@ -72,6 +95,12 @@ public:
 
     // resolve the link to a concrete filesystem path.
     const path& resolve(bool reload = false) const;
+    // view of the file's contents, if its router holds them in memory.
+    optional<span<const unsigned char>> view() const;
+    // the file's contents, viewed in memory or read from disk.
+    file_bytes read() const;
+    // names of the files directly within the linked directory.
+    vector<string> list() const;
 
     /*
      * Context
@@ -168,6 +197,8 @@ private:
     static pct_string_view implicit_package();
 
     link prefix() const;
+    // the complete link this link refers to in the current context.
+    link absolute() const;
 
     // ensure all links have schemes
     void validate()
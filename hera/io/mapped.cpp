@@ -0,0 +1,85 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#if defined(UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <hera/error.hpp>
+#include <hera/utility.hpp>
+#include <hera/io/mapped.hpp>
+
+namespace hera {
+
+#if defined(UNIX)
+
+mapped_file::mapped_file(const path& p)
+{
+    const int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("mapped_file: cannot open {}", p);
+        throw runtime_error("cannot open file");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        LOG_ERROR("mapped_file: cannot stat {}", p);
+        throw runtime_error("cannot stat file");
+    }
+    _size = size_t(st.st_size);
+    if (_size != 0) {
+        void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            LOG_ERROR("mapped_file: cannot map {}", p);
+            throw runtime_error("cannot map file");
+        }
+        _data = static_cast<const unsigned char*>(addr);
+    }
+    // the mapping stays valid without the descriptor.
+    ::close(fd);
+}
+
+mapped_file::~mapped_file()
+{
+    if (_data) {
+        ::munmap(const_cast<unsigned char*>(_data), _size);
+    }
+}
+
+#else
+
+mapped_file::mapped_file(const path& p)
+{
+    try {
+        slurp(p, _buf, ios_base::binary);
+    }
+    catch (const std::exception&) {
+        LOG_ERROR("mapped_file: cannot open {}", p);
+        throw runtime_error("cannot open file");
+    }
+    _data = _buf.data();
+    _size = _buf.size();
+}
+
+mapped_file::~mapped_file() = default;
+
+#endif
+
+} // namespace hera
@@ -0,0 +1,66 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_IO_MAPPED_HPP
+#define HERA_IO_MAPPED_HPP
+
+#include <hera/common.hpp>
+
+namespace hera {
+
+// read-only memory mapping of a whole file.
+//
+// falls back to reading the file into memory where mmap is unavailable.
+class mapped_file {
+public:
+    mapped_file() = default;
+    // maps `p`, throwing runtime_error if it can't be opened.
+    explicit mapped_file(const path& p);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept { swap(other); }
+    mapped_file& operator=(mapped_file&& other) noexcept
+    {
+        mapped_file{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    span<const unsigned char> bytes() const { return {_data, _size}; }
+    size_t size() const { return _size; }
+    explicit operator bool() const { return _data != nullptr; }
+
+    void swap(mapped_file& other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+#if !defined(UNIX)
+        std::swap(_buf, other._buf);
+#endif
+    }
+
+private:
+    const unsigned char* _data = nullptr;
+    size_t _size = 0;
+#if !defined(UNIX)
+    vector<unsigned char> _buf;
+#endif
+};
+
+} // namespace hera
+
+#endif
@@ -84,6 +84,16 @@ size_t route_table::erase(const link& key)
     return rv;
 }
 
+void route_table::node::visit(const function<void(const router&)>& fn) const
+{
+    if (rtr) {
+        fn(*rtr);
+    }
+    for (auto& ch : views::values(children)) {
+        ch.visit(fn);
+    }
+}
+
 size_t route_table::node::size() const
 {
     function<size_t(const node&)> traverse;
@@ -105,12 +115,40 @@ size_t route_table::prune(const link& key)
     return rv;
 }
 
-path fs_router::resolve(const link& u) const
+vector<string> router::list(const link& u) const
+{
+    vector<string> rv;
+    for (auto&& dirent : fs::directory_iterator{resolve(u)}) {
+        if (dirent.is_regular_file()) {
+            rv.push_back(dirent.path().filename().string());
+        }
+    }
+    return rv;
+}
+
+pair<string, string> fs_router::split(const link& u)
 {
     auto segs = u->encoded_segments();
     auto sview = ranges::subrange(segs, segs.size());
-    string domain = sview.front().decode();
+    pair<string, string> rv;
+    if (sview.empty()) {
+        return rv;
+    }
+    rv.first = sview.front().decode();
     sview.advance(1);
+    for (auto seg : sview) {
+        if (!rv.second.empty()) {
+            rv.second.push_back('/');
+        }
+        decode_view dv(seg);
+        rv.second.append(dv.begin(), dv.end());
+    }
+    return rv;
+}
+
+path fs_router::resolve(const link& u) const
+{
+    auto [domain, rest] = split(u);
     path rv;
     if (auto loc = domains.find(domain); loc != domains.end()) {
         rv = loc->second;
@@ -119,13 +157,78 @@ path fs_router::resolve(const link& u) const
         LOG_ERROR("missing domain: {}", u->data());
         throw runtime_error{"missing domain"};
     }
-    for (auto seg : sview) {
-        decode_view dv(seg);
-        rv.append(dv.begin(), dv.end());
+    if (!rest.empty()) {
+        rv /= path{rest}.make_preferred();
     }
     return rv;
 }
 
+/*
+ * ==[[archive_router]]==
+ */
+
+archive_router::archive_router(const toml::table& tbl) : fs_router{tbl}
+{
+    tbl.at("domain").as_array()->for_each([&](const toml::table& dom) {
+        auto file = dom["archive"].value<string>();
+        if (!file) {
+            return;
+        }
+        string id = dom["id"].value_or("null");
+        if (!fs::is_regular_file(*file)) {
+            LOG_DEBUG("archive_router: {}: no archive, using {}", id,
+                      domains.at(id));
+            return;
+        }
+        auto [it, _] = archives.try_emplace(id, path{*file});
+        LOG_INFO("archive_router: {}: {} files from {}", id, it->second.size(),
+                 it->second.file());
+    });
+}
+
+optional<span<const unsigned char>> archive_router::view(const link& u) const
+{
+    auto [domain, rest] = split(u);
+    if (auto it = archives.find(domain); it != archives.end()) {
+        shared_lock lk{_mtx};
+        if (!_stale.empty() && _stale.contains(domain + '/' + rest)) {
+            return nullopt;
+        }
+        return it->second.find(rest);
+    }
+    return nullopt;
+}
+
+void archive_router::touch(const path& p) const
+{
+    for (const auto& [domain, ar] : archives) {
+        auto rel = p.lexically_relative(domains.at(domain));
+        if (rel.empty() || *rel.begin() == "..") {
+            continue;
+        }
+        auto name = rel.generic_string();
+        if (ar.find(name)) {
+            scoped_lock lk{_mtx};
+            if (_stale.insert(domain + '/' + name).second) {
+                LOG_DEBUG("archive_router: {} superseded by {}", name, p);
+            }
+        }
+    }
+}
+
+vector<string> archive_router::list(const link& u) const
+{
+    auto [domain, rest] = split(u);
+    if (auto it = archives.find(domain); it != archives.end()) {
+        vector<string> rv;
+        for (auto name : it->second.list(rest)) {
+            rv.emplace_back(name);
+        }
+        return rv;
+    }
+    return fs_router::list(u);
+}
+
 route_table& route_table::get()
 {
     static route_table global{};
@@ -137,6 +240,29 @@ path route_table::resolve(const link& key)
     return get().at(key).resolve(key);
 }
 
+optional<span<const unsigned char>> route_table::view(const link& key)
+{
+    return get().at(key).view(key);
+}
+
+vector<string> route_table::list(const link& key)
+{
+    return get().at(key).list(key);
+}
+
+vector<path> route_table::roots()
+{
+    vector<path> rv;
+    get().root.visit(
+        [&](const router& r) { ranges::copy(r.roots(), back_inserter(rv)); });
+    return rv;
+}
+
+void route_table::touch(const path& p)
+{
+    get().root.visit([&](const router& r) { r.touch(p); });
+}
+
 void init::route_table()
 {
     Config cfg;
@@ -147,7 +273,7 @@ void init::route_table()
     cfg_provs.for_each([&](const toml::table& elt) {
         link key{"hera://"};
         key->set_host_name(elt["id"].value_or("null"));
-        routes.emplace<fs_router>(key, elt);
+        routes.emplace<archive_router>(key, elt);
     });
 }
 
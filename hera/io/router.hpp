@@ -19,6 +19,7 @@
 
 #include <hera/common.hpp>
 #include <hera/io/link.hpp>
+#include <hera/io/archive.hpp>
 
 namespace hera {
 
@@ -38,13 +39,28 @@ struct router {
     virtual ~router() = default;
 
     virtual path resolve(const link&) const = 0;
+
+    // view of the linked file's contents, if the router holds them in memory.
+    virtual optional<span<const unsigned char>> view(const link&) const
+    {
+        return nullopt;
+    }
+    // names of the files directly within the linked directory.
+    virtual vector<string> list(const link&) const;
+    // directories whose changes should be picked up while running.
+    virtual vector<path> roots() const { return {}; }
+    // notes that the file at `p` changed on disk.
+    virtual void touch(const path&) const {}
 };
 
 struct fs_router : public router {
     // domain -> path
     hash_map<string, string> domains;
+    // domain paths to watch, all but those with `watch = false`.
+    vector<path> watched;
 
     path resolve(const link&) const override;
+    vector<path> roots() const override { return watched; }
 
     // create a new `fs_router` from toml config
     fs_router(const toml::table& tbl)
@@ -53,8 +69,12 @@ struct fs_router : public router {
         if (!doms) {
             throw runtime_error("bad provider");
         }
-        doms->for_each(
-            [&](const toml::table& dom) { domains.emplace(make_domain(dom)); });
+        doms->for_each([&](const toml::table& dom) {
+            auto [it, _] = domains.emplace(make_domain(dom));
+            if (dom["watch"].value_or(true)) {
+                watched.emplace_back(it->second);
+            }
+        });
         LOG_DEBUG("fs_router: {}", fmt::format("{}", domains));
     }
 
@@ -62,6 +82,30 @@ struct fs_router : public router {
     {
         return {dom["id"].value_or("null"), dom["path"].value_or("null")};
     }
+
+    // split a link into its decoded domain and '/'-separated remainder.
+    static pair<string, string> split(const link&);
+};
+
+// an `fs_router` that serves domains packed into archives from memory.
+//
+// domains name their archive with an `archive` key. files missing from an
+// archive, domains whose archive does not exist, and files changed on disk
+// since startup fall back to the filesystem.
+struct archive_router : public fs_router {
+    // domain -> archive
+    hash_map<string, archive> archives;
+
+    archive_router(const toml::table& tbl);
+
+    optional<span<const unsigned char>> view(const link&) const override;
+    vector<string> list(const link&) const override;
+    void touch(const path&) const override;
+
+private:
+    // "domain/name" of packed files superseded by their loose copy.
+    mutable hash_set<string> _stale;
+    mutable shared_mutex _mtx;
 };
 
 class route_table {
@@ -70,6 +114,8 @@ class route_table {
         unique_ptr<router> rtr;
 
         size_t size() const;
+        // calls `fn` on every router at or below this node.
+        void visit(const function<void(const router&)>& fn) const;
     };
     node root;
     using map_type = decltype(node::children);
@@ -119,6 +165,12 @@ public:
     static route_table& get();
 
     static path resolve(const link& key);
+    static optional<span<const unsigned char>> view(const link& key);
+    static vector<string> list(const link& key);
+    // watch roots of every router.
+    static vector<path> roots();
+    // tells every router that the file at `p` changed on disk.
+    static void touch(const path& p);
 };
 
 } // namespace hera
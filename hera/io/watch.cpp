@@ -0,0 +1,172 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cerrno>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <hera/error.hpp>
+#include <hera/io/watch.hpp>
+
+namespace hera {
+
+#if defined(__linux__)
+
+namespace {
+constexpr uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE |
+                                IN_DELETE_SELF | IN_ONLYDIR;
+}
+
+file_watcher::file_watcher()
+{
+    _fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_fd < 0 || ::pipe(_wake) != 0) {
+        LOG_WARNING("file_watcher: inotify unavailable, not watching");
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+        return;
+    }
+    _thread = std::thread{[this] { run(); }};
+}
+
+file_watcher::~file_watcher()
+{
+    if (_thread.joinable()) {
+        const char stop = 0;
+        [[maybe_unused]] auto _ = ::write(_wake[1], &stop, 1);
+        _thread.join();
+    }
+    for (int fd : {_fd, _wake[0], _wake[1]}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+void file_watcher::watch(const path& dir)
+{
+    if (_fd < 0) {
+        return;
+    }
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        LOG_WARNING("file_watcher: not a directory: {}", dir);
+        return;
+    }
+    scoped_lock lk{_mtx};
+    add(dir);
+    for (fs::recursive_directory_iterator it{dir, ec}, end; it != end;
+         it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            add(it->path());
+        }
+    }
+}
+
+// needs the lock.
+void file_watcher::add(const path& dir)
+{
+    const int wd = ::inotify_add_watch(_fd, dir.c_str(), watch_mask);
+    if (wd < 0) {
+        LOG_WARNING("file_watcher: cannot watch {}", dir);
+        return;
+    }
+    _dirs.insert_or_assign(wd, dir);
+    LOG_DEBUG("file_watcher: watching {}", dir);
+}
+
+void file_watcher::run()
+{
+    alignas(inotify_event) char buf[4096];
+    pollfd fds[2] = {{_fd, POLLIN, 0}, {_wake[0], POLLIN, 0}};
+    for (;;) {
+        // sleeps until something happens.
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("file_watcher: poll failed");
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        ssize_t len;
+        while ((len = ::read(_fd, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + len;) {
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + ev->len;
+
+                scoped_lock lk{_mtx};
+                auto it = _dirs.find(ev->wd);
+                if (ev->mask & IN_IGNORED) {
+                    if (it != _dirs.end()) {
+                        _dirs.erase(it);
+                    }
+                    continue;
+                }
+                if (it == _dirs.end() || ev->len == 0) {
+                    continue;
+                }
+                path file = it->second / ev->name;
+                if (ev->mask & IN_ISDIR) {
+                    // new subdirectory, or one moved in.
+                    add(file);
+                }
+                else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    _changed.push(std::move(file));
+                }
+            }
+        }
+    }
+}
+
+#else
+
+file_watcher::file_watcher()
+{
+    LOG_WARNING("file_watcher: unsupported on this platform, not watching");
+}
+
+file_watcher::~file_watcher() = default;
+
+void file_watcher::watch(const path&) {}
+
+void file_watcher::add(const path&) {}
+
+void file_watcher::run() {}
+
+#endif
+
+vector<path> file_watcher::poll()
+{
+    vector<path> rv;
+    path file;
+    while (_changed.try_pop(file)) {
+        if (ranges::find(rv, file) == rv.end()) {
+            rv.push_back(std::move(file));
+        }
+    }
+    return rv;
+}
+
+} // namespace hera
@@ -0,0 +1,61 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_IO_WATCH_HPP
+#define HERA_IO_WATCH_HPP
+
+#include <hera/common.hpp>
+
+namespace hera {
+
+// watches directory trees for files written or moved into place.
+//
+// on linux a background thread blocks on inotify, so an idle watcher costs
+// nothing. elsewhere watching is a no-op.
+class file_watcher {
+public:
+    file_watcher();
+    ~file_watcher();
+
+    file_watcher(const file_watcher&) = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    // watches `dir` and every directory below it, including ones created
+    // later.
+    void watch(const path& dir);
+
+    // files changed since the last call, each reported once.
+    vector<path> poll();
+
+    explicit operator bool() const { return _fd >= 0; }
+
+private:
+    void run();
+    void add(const path& dir);
+
+    int _fd = -1;
+    // written to wake and stop the thread.
+    int _wake[2] = {-1, -1};
+    mutex _mtx;
+    // watch descriptor -> directory
+    hash_map<int, path> _dirs;
+    concurrent_queue<path> _changed;
+    std::thread _thread;
+};
+
+} // namespace hera
+
+#endif
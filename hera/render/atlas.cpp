@@ -0,0 +1,157 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <hera/render/atlas.hpp>
+
+namespace hera {
+
+optional<ShelfPacker::rect> ShelfPacker::take(shelf& s, ivec2 size)
+{
+    // first-fit a gap, keeping any remainder on its right.
+    for (auto it = s.gaps.begin(); it != s.gaps.end(); ++it) {
+        if (it->size.x < size.x) {
+            continue;
+        }
+        rect r{it->pos, {size.x, s.height}};
+        if (it->size.x == size.x) {
+            s.gaps.erase(it);
+        }
+        else {
+            it->pos.x += size.x;
+            it->size.x -= size.x;
+        }
+        return r;
+    }
+    if (s.x + size.x <= _size.x) {
+        rect r{{s.x, s.y}, {size.x, s.height}};
+        s.x += size.x;
+        return r;
+    }
+    return nullopt;
+}
+
+optional<ShelfPacker::rect> ShelfPacker::pack(ivec2 size)
+{
+    size += _pad;
+    if (size.x > _size.x || size.y > _size.y) {
+        return nullopt;
+    }
+    const int height = std::min((size.y + bucket - 1) / bucket * bucket,
+                                _size.y);
+
+    // shelves of the same bucket first.
+    for (auto& s : _shelves) {
+        if (s.height == height) {
+            if (auto r = take(s, size)) {
+                return r;
+            }
+        }
+    }
+    // then the tightest row of an emptied shelf, then fresh space.
+    auto fit = _free.end();
+    for (auto it = _free.begin(); it != _free.end(); ++it) {
+        if (it->height >= height &&
+            (fit == _free.end() || it->height < fit->height)) {
+            fit = it;
+        }
+    }
+    if (fit != _free.end()) {
+        _shelves.push_back({.y = fit->y, .height = height});
+        fit->y += height;
+        fit->height -= height;
+        if (fit->height == 0) {
+            _free.erase(fit);
+        }
+        return take(_shelves.back(), size);
+    }
+    if (_top + height <= _size.y) {
+        _shelves.push_back({.y = _top, .height = height});
+        _top += height;
+        return take(_shelves.back(), size);
+    }
+    // out of fresh rows, so settle for the tightest taller shelf.
+    shelf* best = nullptr;
+    for (auto& s : _shelves) {
+        if (s.height >= size.y && (!best || s.height < best->height)) {
+            if (s.x + size.x <= _size.x ||
+                ranges::any_of(s.gaps, [&](auto& g) -> bool {
+                    return g.size.x >= size.x;
+                })) {
+                best = &s;
+            }
+        }
+    }
+    return best ? take(*best, size) : nullopt;
+}
+
+void ShelfPacker::release(const rect& r)
+{
+    auto it = ranges::find(_shelves, r.pos.y, &shelf::y);
+    assert(it != _shelves.end());
+    if (r.pos.x + r.size.x == it->x) {
+        it->x = r.pos.x;
+    }
+    else {
+        it->gaps.push_back(r);
+    }
+    // once a shelf is empty its row is free for any height.
+    if (it->x == 0 || ranges::fold_left(it->gaps, 0, [](int n, auto& g) {
+                          return n + g.size.x;
+                      }) == it->x) {
+        free_row({it->y, it->height});
+        _shelves.erase(it);
+    }
+}
+
+void ShelfPacker::free_row(row r)
+{
+    auto it = _free.insert(ranges::lower_bound(_free, r.y, {}, &row::y), r);
+    // merge with the free rows either side.
+    if (auto next = it + 1;
+        next != _free.end() && it->y + it->height == next->y) {
+        it->height += next->height;
+        _free.erase(next);
+    }
+    if (it != _free.begin()) {
+        if (auto prev = it - 1; prev->y + prev->height == it->y) {
+            prev->height += it->height;
+            it = _free.erase(it) - 1;
+        }
+    }
+    // a free row at the top rejoins the unshelved space.
+    if (it->y + it->height == _top) {
+        _top = it->y;
+        _free.erase(it);
+    }
+}
+
+float ShelfPacker::occupancy() const
+{
+    int used = _top;
+    for (const auto& r : _free) {
+        used -= r.height;
+    }
+    return float(used) / float(_size.y);
+}
+
+void ShelfPacker::clear()
+{
+    _shelves.clear();
+    _free.clear();
+    _top = 0;
+}
+
+} // namespace hera
@@ -0,0 +1,84 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_ATLAS_HPP
+#define HERA_RENDER_ATLAS_HPP
+
+#include <hera/common.hpp>
+
+namespace hera {
+
+// shelf packing of rectangles into one fixed-size atlas page.
+//
+// rows ("shelves") are opened top to bottom with heights rounded up to
+// `bucket`, so rectangles of similar height share a shelf. released
+// rectangles leave a gap in their shelf that later rectangles may reuse, and
+// emptied shelves free their rows for shelves of any height.
+class ShelfPacker {
+public:
+    static constexpr int bucket = 8;
+
+    // a packed rectangle, including its padding.
+    struct rect {
+        ivec2 pos;
+        ivec2 size;
+    };
+
+    ShelfPacker(ivec2 size, int padding = 1) : _size{size}, _pad{padding} {}
+
+    // packs a rectangle of `size`, or nullopt if the page has no room.
+    optional<rect> pack(ivec2 size);
+    // returns a rectangle from `pack` to the free space of its shelf.
+    void release(const rect&);
+    // forgets every packed rectangle.
+    void clear();
+
+    ivec2 size() const { return _size; }
+    // fraction of the page covered by shelves.
+    float occupancy() const;
+
+private:
+    struct shelf {
+        int y;
+        int height;
+        // end of the packed run.
+        int x = 0;
+        // gaps left by released rectangles.
+        vector<rect> gaps;
+    };
+
+    // rows below `_top` left by emptied shelves.
+    struct row {
+        int y;
+        int height;
+    };
+
+    optional<rect> take(shelf&, ivec2 size);
+    // returns the row of an emptied shelf.
+    void free_row(row);
+
+    ivec2 _size;
+    int _pad;
+    // top of the unshelved space.
+    int _top = 0;
+    vector<shelf> _shelves;
+    // sorted by `y`, never adjacent to each other or to `_top`.
+    vector<row> _free;
+};
+
+} // namespace hera
+
+#endif
@@ -0,0 +1,81 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <hera/render/batch.hpp>
+
+namespace hera {
+
+void GeometryBatch::add(const Geometry& geom, float alpha)
+{
+    auto& b = _buckets[geom.batch_key()];
+    b.proto = &geom;
+    b.instances.push_back(geom.instance(alpha));
+}
+
+void GeometryBatch::draw(Frame& f, float) const
+{
+    collect();
+    for (auto* b : _pending) {
+        draw_bucket(f, *b, true);
+    }
+}
+
+void GeometryBatch::submit(RenderQueue& q, float alpha) const
+{
+    collect();
+    for (uint32_t i = 0; i < _pending.size(); ++i) {
+        const auto* proto = _pending[i]->proto;
+        q.push(*this, alpha, q.material(proto->batch_key()),
+               q.vao(proto->vbuf().vao()), 0, i);
+    }
+}
+
+void GeometryBatch::execute(Frame& f, const RenderCommand& cmd,
+                            bool rebind) const
+{
+    draw_bucket(f, *_pending[cmd.arg], rebind);
+}
+
+void GeometryBatch::collect() const
+{
+    // a new frame, even if the last drew nothing.
+    _draws = _instances = 0;
+    _pending.clear();
+    for (auto& b : views::values(_buckets)) {
+        if (!b.instances.empty()) {
+            _pending.push_back(&b);
+        }
+    }
+}
+
+void GeometryBatch::draw_bucket(Frame& f, bucket& b, bool rebind) const
+{
+    const auto& vbuf = b.proto->vbuf();
+    if (rebind) {
+        b.proto->bind_material(f);
+    }
+    auto& stream = f->stream();
+    auto offset = stream.write(b.instances);
+    vbuf.instances<geometry_instance>(stream.buffer(), offset,
+                                      Geometry::instance_attrib);
+    vbuf.draw(static_cast<GLsizei>(b.instances.size()));
+
+    ++_draws;
+    _instances += b.instances.size();
+    b.instances.clear();
+}
+
+} // namespace hera
@@ -0,0 +1,78 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_BATCH_HPP
+#define HERA_RENDER_BATCH_HPP
+
+#include <hera/common.hpp>
+#include <hera/gl/buffer.hpp>
+#include <hera/render/renderer.hpp>
+#include <hera/render/geometry.hpp>
+
+namespace hera {
+
+// gathers geometry sharing a mesh and material into instanced draws.
+//
+// geometry is added every frame; buckets persist between frames so steady
+// scenes never reallocate. instance data is streamed through the renderer.
+class GeometryBatch : public Drawable {
+private:
+    struct bucket {
+        // any member of the bucket, used to bind the shared state.
+        const Geometry* proto = nullptr;
+        vector<geometry_instance> instances;
+    };
+
+    mutable hash_map<size_t, bucket> _buckets;
+    // non-empty buckets of the current frame, indexed by command arg.
+    mutable vector<bucket*> _pending;
+    mutable size_t _draws = 0;
+    mutable size_t _instances = 0;
+
+public:
+    GeometryBatch() = default;
+
+    void add(const Geometry& geom, float alpha);
+
+    template<ranges::input_range R>
+        requires std::derived_from<range_v<R>, Geometry>
+    void add(const R& geoms, float alpha)
+    {
+        for (const auto& g : geoms) {
+            add(g, alpha);
+        }
+    }
+
+    // issues one draw per bucket and empties the batch.
+    void draw(Frame& f, float alpha) const override;
+    // queues one command per bucket.
+    void submit(RenderQueue& q, float alpha) const override;
+    void execute(Frame& f, const RenderCommand& cmd,
+                 bool rebind) const override;
+
+    // draw calls issued since the last `draw` or `submit`.
+    size_t draws() const { return _draws; }
+    // instances drawn since the last `draw` or `submit`.
+    size_t instances() const { return _instances; }
+
+private:
+    void collect() const;
+    void draw_bucket(Frame& f, bucket& b, bool rebind) const;
+};
+
+} // namespace hera
+
+#endif
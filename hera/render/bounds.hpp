@@ -0,0 +1,111 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_BOUNDS_HPP
+#define HERA_RENDER_BOUNDS_HPP
+
+#include <cstring>
+
+#include <hera/common.hpp>
+#include <hera/gl/vertex.hpp>
+
+namespace hera {
+
+struct aabb {
+    vec3 min{std::numeric_limits<float>::max()};
+    vec3 max{std::numeric_limits<float>::lowest()};
+
+    void expand(const vec3& p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    vec3 center() const { return (min + max) * 0.5f; }
+    vec3 extent() const { return (max - min) * 0.5f; }
+};
+
+struct sphere {
+    vec3 center{0};
+    // unbounded spheres are never culled.
+    float radius = std::numeric_limits<float>::infinity();
+
+    sphere() = default;
+    sphere(const vec3& c, float r) : center{c}, radius{r} {}
+    sphere(const aabb& box) : center{box.center()}, radius{glm::length(box.extent())}
+    {
+    }
+};
+
+// bounds of a vertex range, taking the first attribute as the position.
+template<spanner R>
+    requires gl::is_vertex<range_v<R>>
+aabb bounds_of(const R& vertices)
+{
+    using pos_type = std::tuple_element_t<0, range_v<R>>;
+    static_assert(sizeof(pos_type) == sizeof(vec3),
+                  "vertex position must be 3 floats");
+    aabb box;
+    for (const auto& v : vertices) {
+        vec3 p;
+        std::memcpy(&p, &get<0>(v), sizeof(p));
+        box.expand(p);
+    }
+    return box;
+}
+
+// sphere `s` moved by `m`, growing with its largest scale.
+inline sphere transform(const sphere& s, const mat4& m)
+{
+    float scale2 = std::max({glm::dot(vec3{m[0]}, vec3{m[0]}),
+                             glm::dot(vec3{m[1]}, vec3{m[1]}),
+                             glm::dot(vec3{m[2]}, vec3{m[2]})});
+    return {vec3{m * vec4{s.center, 1}}, s.radius * std::sqrt(scale2)};
+}
+
+// six inward-facing planes as (normal, distance).
+struct Frustum {
+    array<vec4, 6> planes;
+
+    // extracts the planes of a view-projection matrix.
+    static Frustum from(const mat4& viewproj)
+    {
+        auto row = [&](int i) {
+            return vec4{viewproj[0][i], viewproj[1][i], viewproj[2][i],
+                        viewproj[3][i]};
+        };
+        const vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+        Frustum f{{r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2}};
+        for (auto& p : f.planes) {
+            p /= glm::length(vec3{p});
+        }
+        return f;
+    }
+
+    bool contains(const sphere& s) const
+    {
+        for (const auto& p : planes) {
+            if (glm::dot(vec3{p}, s.center) + p.w < -s.radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace hera
+
+#endif
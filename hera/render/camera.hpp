@@ -21,6 +21,7 @@
 #include <hera/gl/program.hpp>
 #include <hera/input.hpp>
 #include <hera/event.hpp>
+#include <hera/render/bounds.hpp>
 
 namespace hera {
 
@@ -79,6 +80,18 @@ public:
 
     void update();
 
+    const vec3& position() const { return _pos; }
+    float znear() const { return _znear; }
+    float zfar() const { return _zfar; }
+    const mat4& view() const { return _view; }
+    const mat4& proj() const { return _proj; }
+    // framebuffer size in pixels.
+    vec2 viewport() const { return _fbsize; }
+    Frustum frustum() const { return Frustum::from(_proj * _view); }
+
+    // uploads the matrices written since the last flush.
+    void flush() { matblock.flush(); }
+
     void load_into(gl::Shaders&) const;
 
     void on_action(input_action);
@@ -0,0 +1,204 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/blocked_range.h>
+
+#include <hera/render/cluster.hpp>
+
+namespace hera {
+
+LightClusters::LightClusters(const gl::Pipeline& scene)
+    : _bounds(count),
+      _counts(count),
+      _scratch(count * max_per_cluster),
+      _grid(count),
+      _grid_tex{gl::internal_f::rg32ui, 4},
+      _index_tex{gl::internal_f::r32ui, 5},
+      _light_tex{gl::internal_f::rgba32f, 6},
+      _uniforms{
+          .mode = scene.resolve<int>("cluster_mode"),
+          .grid = scene.resolve<gl::texture_u>("cluster_grid"),
+          .indices = scene.resolve<gl::texture_u>("cluster_lights"),
+          .lights = scene.resolve<gl::texture_u>("light_data"),
+          .dims = scene.resolve<ivec3>("cluster_dims"),
+          .tile = scene.resolve<vec2>("cluster_tile"),
+          .slicing = scene.resolve<vec2>("cluster_slicing"),
+      }
+{
+    _grid_tex.label("cluster grid");
+    _index_tex.label("cluster lights");
+    _light_tex.label("light data");
+}
+
+void LightClusters::update(const Camera& cam, span<const PointLight> lights)
+{
+    if (!enabled) {
+        return;
+    }
+    auto start = clock::now();
+    if (cam.proj() != _proj) {
+        build_bounds(cam);
+    }
+
+    const auto& view = cam.view();
+    _spheres.resize(lights.size());
+    _light_data.resize(lights.size() * 5);
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const auto& light = lights[i];
+        _spheres[i] = vec4{vec3{view * vec4{light.position, 1}}, light.radius()};
+        auto blk = light.to_block();
+        auto texels = span{&_light_data[i * 5], 5};
+        texels[0] = blk.position;
+        texels[1] = blk.attenuation;
+        texels[2] = blk.ambient;
+        texels[3] = blk.diffuse;
+        texels[4] = blk.specular;
+    }
+
+    assign();
+    upload();
+
+    _stats.lights = lights.size();
+    _stats.assign_time = clock::now() - start;
+}
+
+void LightClusters::load_into(const gl::Pipeline& scene,
+                              const Camera& cam) const
+{
+    // samplers of different types may not share a unit, so always set them.
+    scene.uniform(_uniforms.grid, _grid_tex.unit());
+    scene.uniform(_uniforms.indices, _index_tex.unit());
+    scene.uniform(_uniforms.lights, _light_tex.unit());
+    scene.uniform(_uniforms.mode, int{enabled});
+    if (!enabled) {
+        return;
+    }
+    _grid_tex.bind();
+    _index_tex.bind();
+    _light_tex.bind();
+    scene.uniform(_uniforms.dims, ivec3{tiles_x, tiles_y, slices});
+    scene.uniform(_uniforms.tile, cam.viewport() / vec2{tiles_x, tiles_y});
+    scene.uniform(_uniforms.slicing, slicing());
+}
+
+float LightClusters::slice_depth(uint32_t k) const
+{
+    return _znear * std::pow(_zfar / _znear, float(k) / slices);
+}
+
+vec2 LightClusters::slicing() const
+{
+    float logratio = std::log(_zfar / _znear);
+    return {slices / logratio, -(slices * std::log(_znear)) / logratio};
+}
+
+void LightClusters::build_bounds(const Camera& cam)
+{
+    _proj = cam.proj();
+    _znear = cam.znear();
+    _zfar = cam.zfar();
+
+    const mat4 inv = glm::inverse(_proj);
+    // view-space direction through a point on the near plane.
+    auto unproject = [&](float x, float y) {
+        vec4 p = inv * vec4{x, y, -1, 1};
+        return vec3{p} / p.w;
+    };
+
+    for (uint32_t z = 0; z < slices; ++z) {
+        const float depths[] = {slice_depth(z), slice_depth(z + 1)};
+        for (uint32_t y = 0; y < tiles_y; ++y) {
+            for (uint32_t x = 0; x < tiles_x; ++x) {
+                float x0 = 2.0f * x / tiles_x - 1;
+                float x1 = 2.0f * (x + 1) / tiles_x - 1;
+                float y0 = 2.0f * y / tiles_y - 1;
+                float y1 = 2.0f * (y + 1) / tiles_y - 1;
+                const vec3 corners[] = {unproject(x0, y0), unproject(x1, y0),
+                                        unproject(x0, y1), unproject(x1, y1)};
+
+                aabb b;
+                for (const auto& c : corners) {
+                    for (float d : depths) {
+                        b.expand(c * (d / -c.z));
+                    }
+                }
+                _bounds[x + tiles_x * (y + tiles_y * z)] = b;
+            }
+        }
+    }
+}
+
+void LightClusters::assign()
+{
+    namespace tbb = oneapi::tbb;
+
+    // each task owns whole depth slices, so no froxel is shared.
+    tbb::parallel_for(
+        tbb::blocked_range<uint32_t>{0, slices}, [&](const auto& range) {
+            vector<uint32_t> near;
+            for (uint32_t z = range.begin(); z != range.end(); ++z) {
+                const float dnear = slice_depth(z);
+                const float dfar = slice_depth(z + 1);
+                near.clear();
+                for (uint32_t i = 0; i < _spheres.size(); ++i) {
+                    const auto& s = _spheres[i];
+                    if (-s.z + s.w >= dnear && -s.z - s.w <= dfar) {
+                        near.push_back(i);
+                    }
+                }
+
+                for (uint32_t c = z * tiles_x * tiles_y,
+                              end = c + tiles_x * tiles_y;
+                     c < end; ++c) {
+                    const auto& b = _bounds[c];
+                    uint32_t* list = &_scratch[c * max_per_cluster];
+                    uint32_t n = 0;
+                    for (auto i : near) {
+                        const auto& s = _spheres[i];
+                        vec3 center{s};
+                        vec3 d = glm::clamp(center, b.min, b.max) - center;
+                        if (glm::dot(d, d) <= s.w * s.w &&
+                            n < max_per_cluster) {
+                            list[n++] = i;
+                        }
+                    }
+                    _counts[c] = n;
+                }
+            }
+        });
+
+    // compact the fixed-stride lists.
+    _indices.clear();
+    _stats.max_lights = 0;
+    for (size_t c = 0; c < count; ++c) {
+        auto n = _counts[c];
+        _grid[c] = uvec2(_indices.size(), n);
+        auto list = span{&_scratch[c * max_per_cluster], n};
+        _indices.insert(_indices.end(), list.begin(), list.end());
+        _stats.max_lights = std::max<size_t>(_stats.max_lights, n);
+    }
+    _stats.references = _indices.size();
+}
+
+void LightClusters::upload()
+{
+    _grid_tex.data(_grid);
+    _index_tex.data(_indices);
+    _light_tex.data(_light_data);
+}
+
+} // namespace hera
@@ -0,0 +1,114 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_CLUSTER_HPP
+#define HERA_RENDER_CLUSTER_HPP
+
+#include <hera/common.hpp>
+#include <hera/gl/program.hpp>
+#include <hera/gl/texture.hpp>
+#include <hera/render/bounds.hpp>
+#include <hera/render/camera.hpp>
+#include <hera/render/light.hpp>
+
+namespace hera {
+
+// clustered forward lighting.
+//
+// the view frustum is split into a grid of froxels, screen-space tiles that
+// are sliced exponentially in depth. each frame the point lights are
+// assigned to the froxels they touch, and the per-froxel light lists are
+// uploaded to buffer textures that scene.frag walks.
+class LightClusters {
+public:
+    static constexpr uint32_t tiles_x = 16;
+    static constexpr uint32_t tiles_y = 9;
+    static constexpr uint32_t slices = 24;
+    static constexpr size_t count = tiles_x * tiles_y * slices;
+    // lights considered per froxel, further lights are dropped.
+    static constexpr size_t max_per_cluster = 128;
+
+    struct stats {
+        size_t lights = 0;
+        // total light references across all froxels.
+        size_t references = 0;
+        // most lights in a single froxel.
+        size_t max_lights = 0;
+        duration<float, std::milli> assign_time{0};
+    };
+
+private:
+    // view-space bounds of each froxel, rebuilt when the projection changes.
+    vector<aabb> _bounds;
+    mat4 _proj{0};
+    float _znear = 0;
+    float _zfar = 0;
+
+    // view-space position and radius of each light.
+    vector<vec4> _spheres;
+    // fixed-stride light lists filled in parallel, then compacted.
+    vector<uint32_t> _counts;
+    vector<uint32_t> _scratch;
+
+    // offset and count into `_indices` for each froxel.
+    vector<uvec2> _grid;
+    vector<uint32_t> _indices;
+    // PointLight::block of each light as 5 texels.
+    vector<vec4> _light_data;
+
+    gl::TextureBuffer _grid_tex;
+    gl::TextureBuffer _index_tex;
+    gl::TextureBuffer _light_tex;
+
+    struct uniforms {
+        gl::UniformHandle<int> mode;
+        gl::UniformHandle<gl::texture_u> grid;
+        gl::UniformHandle<gl::texture_u> indices;
+        gl::UniformHandle<gl::texture_u> lights;
+        gl::UniformHandle<ivec3> dims;
+        gl::UniformHandle<vec2> tile;
+        gl::UniformHandle<vec2> slicing;
+    } _uniforms;
+
+    stats _stats;
+
+public:
+    bool enabled = true;
+
+    LightClusters(const gl::Pipeline& scene);
+
+    // assigns lights to froxels and uploads the results.
+    void update(const Camera&, span<const PointLight>);
+
+    // binds the light lists and sets the cluster uniforms of `scene`.
+    void load_into(const gl::Pipeline& scene, const Camera&) const;
+
+    const stats& last_stats() const { return _stats; }
+
+private:
+    void build_bounds(const Camera&);
+    void assign();
+    void upload();
+
+    // view depth of the near plane of slice `k`.
+    float slice_depth(uint32_t k) const;
+    // scale and bias mapping log(view depth) to a depth slice.
+    vec2 slicing() const;
+};
+
+} // namespace hera
+
+#endif
@@ -78,22 +78,35 @@ struct gl::vertex<cube_vertex> : attributes<vec3, vec3, vec2> {};
 Cube::Cube(const link& diff, const link& spec, const vec3& pos,
            const vec3& axis, float offset)
     : Geometry{vertices},
-      material{{diff, {.min_filter = GL_LINEAR_MIPMAP_LINEAR}, 0},
-               {spec, {.min_filter = GL_LINEAR_MIPMAP_LINEAR}, 1},
+      material{gl::Texture2d::load_async(
+                   diff, {.min_filter = GL_LINEAR_MIPMAP_LINEAR}, 0),
+               gl::Texture2d::load_async(
+                   spec, {.min_filter = GL_LINEAR_MIPMAP_LINEAR}, 1),
                64},
       _pos{pos},
       _axis{axis},
       _angle{0},
       _offset{offset} {};
 
-void Cube::draw(Frame& f, float alpha) const
+void Cube::bind_material(Frame& f) const
 {
     const auto& shader = f->pipeline();
+    if (_mat_pipeline != &shader) {
+        _mat_uniforms = {shader, "material"};
+        _mat_pipeline = &shader;
+    }
     material.diffuse.bind(0);
     material.specular.bind(1);
-    material.load_into("material", shader);
+    material.load_into(_mat_uniforms, shader);
+}
 
-    Geometry::draw(f, alpha);
+size_t Cube::batch_key() const
+{
+    size_t seed = Geometry::batch_key();
+    boost::hash_combine(seed, material.diffuse.id());
+    boost::hash_combine(seed, material.specular.id());
+    boost::hash_combine(seed, material.shine);
+    return seed;
 }
 
 } // namespace hera
@@ -39,6 +39,9 @@ class Cube : public Geometry {
     static constexpr float increment = tau * rotate_rate * tickrate();
 
     Material2 material;
+    // material handles and the pipeline they were resolved in.
+    mutable Material2::uniforms _mat_uniforms;
+    mutable const gl::Pipeline* _mat_pipeline = nullptr;
     vec3 _pos;
     vec3 _axis;
     float _angle;
@@ -48,7 +51,8 @@ public:
     Cube(const link& diff, const link& spec, const vec3& pos = vec3{0.0},
          const vec3& axis = vec3{1.0, 0.0, 0.0}, float offset = 0.0);
 
-    void draw(Frame& f, float) const override;
+    void bind_material(Frame& f) const override;
+    size_t batch_key() const override;
 
     void update()
     {
@@ -0,0 +1,83 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstring>
+
+#include <hera/render/cull.hpp>
+
+namespace hera {
+
+namespace {
+// portable SIMD through the vector extensions of gcc and clang.
+using floatv =
+    float __attribute__((vector_size(Culler::width * sizeof(float))));
+using maskv =
+    int32_t __attribute__((vector_size(Culler::width * sizeof(int32_t))));
+
+floatv load(const float* p)
+{
+    floatv v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+} // namespace
+
+uint32_t Culler::add(const sphere& s)
+{
+    if (_size == _x.size()) {
+        auto n = _size + width;
+        _x.resize(n);
+        _y.resize(n);
+        _z.resize(n);
+        _r.resize(n);
+    }
+    _x[_size] = s.center.x;
+    _y[_size] = s.center.y;
+    _z[_size] = s.center.z;
+    _r[_size] = s.radius;
+    return _size++;
+}
+
+span<const uint32_t> Culler::cull(const Frustum& f)
+{
+    _visible.clear();
+
+    for (size_t i = 0; i < _size; i += width) {
+        const floatv x = load(&_x[i]);
+        const floatv y = load(&_y[i]);
+        const floatv z = load(&_z[i]);
+        const floatv r = load(&_r[i]);
+
+        maskv inside = maskv{} - 1;
+        for (const auto& p : f.planes) {
+            floatv d = x * p.x + y * p.y + z * p.z + p.w;
+            inside &= d >= -r;
+        }
+
+        const size_t lanes = std::min(width, _size - i);
+        for (size_t l = 0; l < lanes; ++l) {
+            if (inside[l]) {
+                _visible.push_back(i + l);
+            }
+        }
+    }
+
+    _stats.tested = _size;
+    _stats.visible = _visible.size();
+    return _visible;
+}
+
+} // namespace hera
@@ -0,0 +1,69 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_CULL_HPP
+#define HERA_RENDER_CULL_HPP
+
+#include <hera/common.hpp>
+#include <hera/render/bounds.hpp>
+
+namespace hera {
+
+// frustum culling of bounding spheres.
+//
+// spheres are stored as structure-of-arrays and tested `width` at a time
+// against all six planes.
+class Culler {
+public:
+    static constexpr size_t width = 8;
+
+    struct stats {
+        size_t tested = 0;
+        size_t visible = 0;
+
+        size_t culled() const { return tested - visible; }
+    };
+
+private:
+    // padded to a multiple of `width`.
+    vector<float> _x;
+    vector<float> _y;
+    vector<float> _z;
+    vector<float> _r;
+    size_t _size = 0;
+
+    vector<uint32_t> _visible;
+    stats _stats;
+
+public:
+    Culler() = default;
+
+    // removes all spheres.
+    void clear() { _size = 0; }
+
+    // adds a sphere, returning its index.
+    uint32_t add(const sphere& s);
+
+    // indices of the spheres intersecting `f`, in ascending order.
+    span<const uint32_t> cull(const Frustum& f);
+
+    size_t size() const { return _size; }
+    const stats& last_stats() const { return _stats; }
+};
+
+} // namespace hera
+
+#endif
@@ -20,9 +20,38 @@ namespace hera {
 
 void Geometry::draw(Frame& f, float alpha) const
 {
-    auto model = interpolate(alpha);
-    f->pipeline().uniform("model", model);
-    _vbuf.draw();
+    bind_material(f);
+    draw_instance(f, alpha);
+}
+
+void Geometry::submit(RenderQueue& q, float alpha) const
+{
+    vec3 pos = _model[3];
+    q.push(*this, alpha, q.material(batch_key()), q.vao(_vbuf.vao()),
+           q.depth(pos));
+}
+
+void Geometry::execute(Frame& f, const RenderCommand& cmd, bool rebind) const
+{
+    if (rebind) {
+        bind_material(f);
+    }
+    draw_instance(f, cmd.alpha);
+}
+
+void Geometry::draw_instance(Frame& f, float alpha) const
+{
+    auto& stream = f->stream();
+    geometry_instance inst = instance(alpha);
+    auto offset = stream.write(span{&inst, 1});
+    _vbuf.instances<geometry_instance>(stream.buffer(), offset,
+                                       instance_attrib);
+    _vbuf.draw(1);
+}
+
+size_t Geometry::batch_key() const
+{
+    return boost::hash<GLuint>{}(_vbuf.vao());
 }
 
 } // namespace hera
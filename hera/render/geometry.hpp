@@ -25,6 +25,7 @@
 #include <hera/gl/buffer.hpp>
 #include <hera/gl/program.hpp>
 #include <hera/render/renderer.hpp>
+#include <hera/render/bounds.hpp>
 #include <utility>
 
 namespace hera {
@@ -46,19 +47,65 @@ static constexpr uint16_t basic_quad_indices[] = {0, 1, 3, 1, 2, 3};
 
 } // namespace
 
-class Geometry : Drawable {
+// per-instance attributes of instanced geometry.
+struct geometry_instance {
+    vec4 c0, c1, c2, c3;
+
+    geometry_instance() = default;
+    geometry_instance(const mat4& m) : c0{m[0]}, c1{m[1]}, c2{m[2]}, c3{m[3]} {}
+};
+
+class Geometry : public Drawable {
 private:
     mat4 _model{1.0f};
     mat4 _prev_model{1.0f};
+    // model-space bounds, unbounded unless built from vertices.
+    sphere _bounds;
 
 protected:
     gl::VertexBuffer _vbuf;
 
     Geometry() = default;
     Geometry(gl::VertexBuffer vbuf) : _vbuf{std::move(vbuf)} {}
+    Geometry(gl::VertexBuffer vbuf, const sphere& bounds)
+        : _bounds{bounds},
+          _vbuf{std::move(vbuf)}
+    {
+    }
+
+    template<spanner R>
+        requires gl::is_vertex<range_v<R>>
+    Geometry(const R& vertices)
+        : _bounds{bounds_of(vertices)},
+          _vbuf{vertices}
+    {
+    }
 
 public:
+    // first attribute location of the per-instance stream.
+    static constexpr GLuint instance_attrib = 3;
+
+    // draws a single instance.
     void draw(Frame& f, float alpha) const override;
+    void submit(RenderQueue& q, float alpha) const override;
+    void execute(Frame& f, const RenderCommand& cmd,
+                 bool rebind) const override;
+
+    // binds the state shared by every instance of a batch.
+    virtual void bind_material(Frame&) const {}
+
+    // geometry with equal keys may be drawn as instances of one another.
+    virtual size_t batch_key() const;
+
+    const gl::VertexBuffer& vbuf() const { return _vbuf; }
+
+    geometry_instance instance(float alpha) const
+    {
+        return interpolate(alpha);
+    }
+
+    // world-space bounds at the current model transform.
+    sphere bounds() const { return transform(_bounds, _model); }
 
     const mat4& model() const { return _model; }
     void model(const mat4& model)
@@ -67,6 +114,8 @@ public:
     }
 
 private:
+    void draw_instance(Frame& f, float alpha) const;
+
     mat4 interpolate(float alpha) const
     {
         return glm::interpolate(_prev_model, _model, alpha);
@@ -76,6 +125,9 @@ private:
 template<>
 struct gl::vertex<quad_vertex> : attributes<vec3, vec2> {};
 
+template<>
+struct gl::vertex<geometry_instance> : attributes<vec4, vec4, vec4, vec4> {};
+
 } // namespace hera
 
 #endif
@@ -14,6 +14,8 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <cstring>
+
 #include <glm/ext/matrix_transform.hpp>
 
 #include <hera/render/light.hpp>
@@ -26,23 +28,75 @@ void PointLight::draw(Frame& f, float) const
     vbuf.draw();
 }
 
-void PointLight::load_into(const string& root, const gl::Pipeline& prog) const
+void PointLight::submit(RenderQueue& q, float alpha) const
+{
+    q.push(*this, alpha, 0, q.vao(vbuf.vao()), q.depth(position));
+}
+
+sphere PointLight::bounds() const
+{
+    static const sphere local{bounds_of(detail::light_vertices)};
+    return transform(local, model);
+}
+
+float PointLight::radius() const
+{
+    vec3 m = glm::max(diffuse, specular);
+    float peak = std::max({m.x, m.y, m.z});
+    // solve constant + linear*d + quadratic*d^2 = 256 * peak
+    float c = constant - 256.0f * peak;
+    if (quadratic > 0) {
+        float disc = linear * linear - 4 * quadratic * c;
+        return (-linear + std::sqrt(std::max(disc, 0.0f))) / (2 * quadratic);
+    }
+    else if (linear > 0) {
+        return std::max(-c / linear, 0.0f);
+    }
+    else {
+        return std::numeric_limits<float>::infinity();
+    }
+}
+
+// =====[LightBlock]=====
+
+LightBlock::LightBlock(size_t max_point_lights)
+    : _header{"Lighting"},
+      _points{"PointLights", max_point_lights}
+{
+    _header.write<count_idx>(_count);
+}
+
+void LightBlock::set(const DirLight& light)
+{
+    _header.write_all(_count, light.direction, light.ambient, light.diffuse,
+                      light.specular);
+}
+
+void LightBlock::set(size_t i, const PointLight& light)
+{
+    if (i >= capacity()) {
+        return;
+    }
+    auto blk = light.to_block();
+    if (std::memcmp(&_points[i], &blk, sizeof(blk)) != 0) {
+        _points.set(i, blk);
+    }
+}
+
+void LightBlock::resize(size_t n)
 {
-    prog.uniform(root + ".position", position);
-    prog.uniform(root + ".constant", constant);
-    prog.uniform(root + ".linear", linear);
-    prog.uniform(root + ".quadratic", quadratic);
-    prog.uniform(root + ".ambient", ambient);
-    prog.uniform(root + ".diffuse", diffuse);
-    prog.uniform(root + ".specular", specular);
+    // the shader reads the count as an int.
+    const int count = static_cast<int>(std::min(n, capacity()));
+    if (count != _count) {
+        _count = count;
+        _header.write<count_idx>(_count);
+    }
 }
 
-void DirLight::load_into(const string& root, const gl::Pipeline& prog) const
+void LightBlock::load_into(gl::Shaders& shaders) const
 {
-    prog.uniform(root + ".direction", direction);
-    prog.uniform(root + ".ambient", ambient);
-    prog.uniform(root + ".diffuse", diffuse);
-    prog.uniform(root + ".specular", specular);
+    shaders.add_block(_header);
+    shaders.add_block(_points);
 }
 
 } // namespace hera
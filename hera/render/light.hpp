@@ -21,6 +21,7 @@
 #include <hera/gl/buffer.hpp>
 #include <hera/gl/program.hpp>
 #include <hera/render/renderer.hpp>
+#include <hera/render/bounds.hpp>
 
 namespace hera {
 
@@ -65,19 +66,53 @@ struct PointLight : public Drawable {
     gl::VertexBuffer vbuf{detail::light_vertices};
     mat4 model{1.0};
 
-    PointLight(vec3 pos) : position{pos}
+    PointLight(vec3 pos) : position{pos} { place(pos); };
+
+    // moves the light and its geometry.
+    void place(vec3 pos)
     {
-        model = glm::translate(model, pos);
+        position = pos;
+        model = glm::translate(mat4{1.0}, pos);
         model = glm::scale(model, vec3{0.2});
+    }
+
+    // distance past which the light contributes less than 1/256.
+    float radius() const;
+
+    // world-space bounds of the light's geometry.
+    sphere bounds() const;
+
+    // std140 layout of a light in the PointLights block.
+    struct block {
+        vec4 position;
+        // constant, linear, quadratic
+        vec4 attenuation;
+        vec4 ambient;
+        vec4 diffuse;
+        vec4 specular;
     };
 
+    block to_block() const
+    {
+        return {
+            .position = vec4{position, 1},
+            .attenuation = vec4{constant, linear, quadratic, 0},
+            .ambient = vec4{ambient, 0},
+            .diffuse = vec4{diffuse, 0},
+            .specular = vec4{specular, 0},
+        };
+    }
+
     // draw the light source's actual geometry.
     void draw(Frame& f, float delta) const override;
+    void submit(RenderQueue& q, float alpha) const override;
 
-    // load light parameters into given shader.
-    void load_into(const string& root, const gl::Pipeline&) const;
 };
 
+template<>
+struct gl::block_struct<PointLight::block>
+    : members<vec4, vec4, vec4, vec4, vec4> {};
+
 struct DirLight {
     vec3 direction;
     vec3 ambient = {.1, .1, .1};
@@ -85,8 +120,46 @@ struct DirLight {
     vec3 specular = {.5, .5, .5};
 
     DirLight(vec3 dir) : direction{dir} {};
+};
+
+// the lights of a scene, held in two uniform blocks:
+//
+//   Lighting { int n_point_lights; DirLight dir_light; }
+//   PointLights { PointLight point_lights[MAX_POINT_LIGHTS]; }
+//
+// point lights are mirrored on the CPU and only changed lights are uploaded.
+class LightBlock {
+    static constexpr size_t count_idx = 0;
+    static constexpr size_t direction_idx = 1;
+    static constexpr size_t ambient_idx = 2;
+    static constexpr size_t diffuse_idx = 3;
+    static constexpr size_t specular_idx = 4;
+
+    gl::UniformBuffer<int, vec3, vec3, vec3, vec3> _header;
+    gl::UniformArray<PointLight::block> _points;
+    int _count = 0;
+
+public:
+    LightBlock(size_t max_point_lights);
+
+    // maximum number of point lights.
+    size_t capacity() const { return _points.size(); }
+    // number of active point lights.
+    size_t size() const { return _count; }
+
+    void set(const DirLight&);
+    void set(size_t i, const PointLight&);
+    // sets the number of active point lights, clamped to capacity.
+    void resize(size_t n);
+
+    // uploads changed point lights.
+    void flush()
+    {
+        _header.flush();
+        _points.flush();
+    }
 
-    void load_into(const string& root, const gl::Pipeline&) const;
+    void load_into(gl::Shaders&) const;
 };
 
 } // namespace hera
@@ -18,36 +18,71 @@
 
 namespace hera {
 
+Material2::uniforms::uniforms(const gl::Pipeline& prog, const string& root)
+    : diffuse{prog.resolve<gl::texture_u>(root + ".diffuse")},
+      specular{prog.resolve<gl::texture_u>(root + ".specular")},
+      shine{prog.resolve<float>(root + ".shine")}
+{
+}
+
+void Material2::load_into(const uniforms& u, const gl::Pipeline& prog) const
+{
+    prog.uniform(u.diffuse, diffuse.unit());
+    prog.uniform(u.specular, specular.unit());
+    prog.uniform(u.shine, shine);
+}
+
 void Material2::load_into(const string& root, const gl::Pipeline& prog) const
 {
     prog.uniform(root + ".diffuse", diffuse.unit());
     prog.uniform(root + ".specular", specular.unit());
     prog.uniform(root + ".shine", shine);
-    gl::checkerror();
 }
 
-Material::Material(const aiMaterial* mat)
+namespace {
+// link to a texture named relative to the model file.
+optional<link> texture_link(const aiMaterial* mat, aiTextureType type,
+                            const link& model)
+{
+    aiString name;
+    if (mat->GetTexture(type, 0, &name) != aiReturn_SUCCESS ||
+        name.length == 0) {
+        return nullopt;
+    }
+    string rel{name.C_Str()};
+    ranges::replace(rel, '\\', '/');
+
+    link rv = model.parent_path();
+    auto segs = rv->segments();
+    for (auto part : views::split(rel, '/')) {
+        string_view seg{part.begin(), part.end()};
+        if (!seg.empty() && seg != ".") {
+            segs.push_back(seg);
+        }
+    }
+    return rv;
+}
+} // namespace
+
+Material::Material(const aiMaterial* mat, const link& model)
 {
     aiColor3D color;
-    if (mat->Get(AI_MATKEY_COLOR_AMBIENT, color)) {
+    if (mat->Get(AI_MATKEY_COLOR_AMBIENT, color) == aiReturn_SUCCESS) {
         color_ambient = to_glm(color);
     }
-    if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color)) {
+    if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == aiReturn_SUCCESS) {
         color_diffuse = to_glm(color);
     }
-    if (mat->Get(AI_MATKEY_COLOR_SPECULAR, color)) {
+    if (mat->Get(AI_MATKEY_COLOR_SPECULAR, color) == aiReturn_SUCCESS) {
         color_specular = to_glm(color);
     }
-    mat->Get(AI_MATKEY_SHININESS, shininess);
-
-    aiString pat;
-    mat->GetTexture(aiTextureType_DIFFUSE, 0, &pat);
-    link lnk{pat.C_Str()};
-    tex_diffuse.allocate(lnk);
-
-    mat->GetTexture(aiTextureType_SPECULAR, 0, &pat);
-    lnk = {pat.C_Str()};
-    tex_specular.allocate(lnk);
+    float shine;
+    if (mat->Get(AI_MATKEY_SHININESS, shine) == aiReturn_SUCCESS &&
+        shine > 0) {
+        shininess = shine;
+    }
+    tex_diffuse = texture_link(mat, aiTextureType_DIFFUSE, model);
+    tex_specular = texture_link(mat, aiTextureType_SPECULAR, model);
 }
 
 } // namespace hera
@@ -26,21 +26,19 @@
 
 namespace hera {
 
+// the surface of an imported model as described by its file. textures are
+// only linked, becoming gpu textures when the model is uploaded.
 struct Material {
     vec3 color_ambient{1.0};
     vec3 color_diffuse{1.0};
     vec3 color_specular{1.0};
-    float shininess{1.0};
-    gl::Texture2d tex_diffuse;
-    gl::Texture2d tex_specular;
+    float shininess{32.0};
+    optional<link> tex_diffuse;
+    optional<link> tex_specular;
 
     Material() = default;
-    Material(const aiMaterial*);
-};
-
-template<>
-struct asset<Material[]> {
-    shared_ptr<Material[]> load_from(const link& p);
+    // reads `mat`, linking textures relative to the directory of `model`.
+    Material(const aiMaterial* mat, const link& model);
 };
 
 struct Material2 {
@@ -48,11 +46,21 @@ struct Material2 {
     gl::Texture2d specular;
     float shine;
 
+    struct uniforms {
+        gl::UniformHandle<gl::texture_u> diffuse;
+        gl::UniformHandle<gl::texture_u> specular;
+        gl::UniformHandle<float> shine;
+
+        uniforms() = default;
+        uniforms(const gl::Pipeline&, const string& root);
+    };
+
     Material2(gl::Texture2d diff, gl::Texture2d spec, float shine)
         : diffuse{std::move(diff)},
           specular{std::move(spec)},
           shine{shine} {};
 
+    void load_into(const uniforms&, const gl::Pipeline&) const;
     void load_into(const string& root, const gl::Pipeline&) const;
 };
 
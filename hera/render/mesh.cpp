@@ -0,0 +1,59 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <hera/render/mesh.hpp>
+#include <hera/render/assimp_util.hpp>
+
+namespace hera {
+
+Mesh::Mesh(const aiMesh* mesh, const mat4& xform)
+    : material{mesh->mMaterialIndex}
+{
+    const mat3 normal_xform = glm::inverseTranspose(mat3{xform});
+    const bool has_tex = mesh->HasTextureCoords(0);
+
+    vertices.resize(mesh->mNumVertices);
+    for (unsigned i = 0; i < mesh->mNumVertices; ++i) {
+        auto& v = vertices[i];
+        v.position = vec3{xform * vec4{to_glm(mesh->mVertices[i]), 1.0}};
+        if (mesh->mNormals) {
+            v.normal = glm::normalize(normal_xform *
+                                      to_glm(mesh->mNormals[i]));
+        }
+        else {
+            v.normal = vec3{0.0};
+        }
+        if (has_tex) {
+            v.tex = vec2{to_glm(mesh->mTextureCoords[0][i])};
+        }
+        else {
+            v.tex = vec2{0.0};
+        }
+    }
+
+    indices.reserve(size_t(mesh->mNumFaces) * 3);
+    for (unsigned i = 0; i < mesh->mNumFaces; ++i) {
+        const aiFace& face = mesh->mFaces[i];
+        if (face.mNumIndices != 3) {
+            continue;
+        }
+        indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+    }
+}
+
+} // namespace hera
@@ -24,7 +24,9 @@
 
 namespace hera {
 
+// the triangles of one imported mesh.
 class Mesh {
+public:
     struct vertex {
         vec3 position;
         vec3 normal;
@@ -33,8 +35,13 @@ class Mesh {
 
     vector<vertex> vertices;
     vector<uint32_t> indices;
+    // index into the scene's materials.
+    uint32_t material = 0;
 
-    Mesh(const aiMesh*, const aiScene*);
+    Mesh() = default;
+    // copies `mesh`, moving it into model space by `xform`. faces that
+    // aren't triangles are skipped.
+    Mesh(const aiMesh* mesh, const mat4& xform);
 };
 
 template<>
@@ -14,32 +14,705 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <cstring>
+
+#include <oneapi/tbb/parallel_for.h>
+
+#include <hera/utility.hpp>
 #include <hera/render/model.hpp>
+#include <hera/render/assimp_util.hpp>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+namespace tbb = oneapi::tbb;
+
 namespace hera {
 
 namespace {
+// importers aren't thread-safe, so each loader thread has its own.
 Assimp::Importer& get_importer()
 {
-    static Assimp::Importer obj;
+    thread_local Assimp::Importer obj;
     return obj;
 }
+
+// shared vertices are what make indexing pay off.
+constexpr unsigned import_flags =
+    aiProcess_Triangulate | aiProcess_FlipUVs |
+    aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals;
+
+// levels of detail built on import, each with half the triangles of the
+// last, stopping once the surface would move by a tenth of the model's size.
+constexpr size_t lod_levels = 5;
+constexpr float lod_ratio = 0.5f;
+constexpr float lod_max_error = 0.1f;
+
+// a mesh placed by the node hierarchy.
+struct placement {
+    const aiMesh* mesh;
+    mat4 xform;
+};
+
+void collect(const aiScene* scene, const aiNode* node, const mat4& parent,
+             vector<placement>& out)
+{
+    const mat4 xform = parent * to_glm(node->mTransformation);
+    for (unsigned i = 0; i < node->mNumMeshes; ++i) {
+        out.push_back({scene->mMeshes[node->mMeshes[i]], xform});
+    }
+    for (unsigned i = 0; i < node->mNumChildren; ++i) {
+        collect(scene, node->mChildren[i], xform, out);
+    }
+}
+
+// a 1x1 texture of one grey level, standing in for a missing texture.
+gl::Texture2d plain_texture(unsigned char level)
+{
+    const array<unsigned char, 4> px{level, level, level, 255};
+    gl::Texture2d tex;
+    tex.bind();
+    gl::TextureParams{}.apply(gl::Texture2d::target);
+    gl::allocate(gl::Texture2d::target, gl::internal_f::rgba, 1, 1, px);
+    return tex;
+}
 } // namespace
 
+/*
+ * ==[[Model]]==
+ */
+
+void Model::merge(span<const Mesh> meshes)
+{
+    // grouped by material, each group becomes a single draw.
+    vector<uint32_t> order;
+    size_t n_vertices = 0;
+    size_t n_indices = 0;
+    for (uint32_t i = 0; i < meshes.size(); ++i) {
+        order.push_back(i);
+        n_vertices += meshes[i].vertices.size();
+        n_indices += meshes[i].indices.size();
+    }
+    ranges::stable_sort(order, {},
+                        [&](uint32_t i) { return meshes[i].material; });
+
+    vertices.reserve(vertices.size() + n_vertices);
+    indices.reserve(indices.size() + n_indices);
+    for (auto i : order) {
+        const auto& m = meshes[i];
+        if (m.indices.empty()) {
+            continue;
+        }
+        if (submeshes.empty() || submeshes.back().material != m.material) {
+            submeshes.push_back({uint32_t(indices.size()), 0, m.material});
+        }
+        const auto base = uint32_t(vertices.size());
+        for (const auto& v : m.vertices) {
+            vertices.push_back(v);
+            box.expand(v.position);
+        }
+        for (auto idx : m.indices) {
+            indices.push_back(base + idx);
+        }
+        submeshes.back().count += m.indices.size();
+    }
+    _stats.meshes += meshes.size();
+    _stats.vertices = vertices.size();
+    _stats.triangles = indices.size() / 3;
+}
+
+void Model::build_lods(size_t levels, float ratio, float max_error)
+{
+    lods.assign(1, lod{0, uint32_t(submeshes.size()), 0.0f});
+    const auto positions = positions_of(vertices);
+    const float radius = glm::length(box.extent());
+    if (radius <= 0) {
+        return;
+    }
+    while (lods.size() < levels && lods.back().error < max_error) {
+        const lod prev = lods.back();
+        // what's left of the error budget after the levels so far.
+        const float budget = (max_error - prev.error) * radius;
+        const size_t n_indices = indices.size();
+        vector<submesh> next;
+        size_t before = 0;
+        // the step's largest error. quadrics start afresh from the previous
+        // level, so drift from the full model is the sum of the steps.
+        float step = 0;
+        for (uint32_t i = prev.first; i < prev.first + prev.count; ++i) {
+            const submesh sub = submeshes[i];
+            float error = 0;
+            auto simplified = simplify(
+                span{indices}.subspan(sub.first, sub.count), positions,
+                size_t(sub.count * ratio) / 3 * 3, budget, error);
+            before += sub.count;
+            step = std::max(step, error / radius);
+            if (simplified.empty()) {
+                continue;
+            }
+            optimize_cache(simplified, vertices.size());
+            next.push_back({uint32_t(indices.size()),
+                            uint32_t(simplified.size()), sub.material});
+            indices.insert(indices.end(), simplified.begin(),
+                           simplified.end());
+        }
+        // a level that barely simplifies isn't worth its memory.
+        if (indices.size() - n_indices > before * 9 / 10) {
+            indices.resize(n_indices);
+            break;
+        }
+        lods.push_back({uint32_t(submeshes.size()), uint32_t(next.size()),
+                        prev.error + step});
+        submeshes.insert(submeshes.end(), next.begin(), next.end());
+    }
+}
+
+void Model::upload()
+{
+    if (_vbuf) {
+        return;
+    }
+    _vbuf.emplace(vertex_data(), index_data());
+
+    optional<gl::Texture2d> white;
+    optional<gl::Texture2d> black;
+    auto texture = [&](const optional<link>& l, optional<gl::Texture2d>& alt,
+                       unsigned char level) -> gl::Texture2d {
+        if (l) {
+            try {
+                // models sharing an image share its texture.
+                auto tex = assets::get<gl::Texture2d>(*l);
+                if (ranges::find(_textures, tex) == _textures.end()) {
+                    _textures.push_back(tex);
+                }
+                return *tex;
+            }
+            catch (const std::exception&) {
+                LOG_WARNING("missing texture: {}", *l);
+            }
+        }
+        if (!alt) {
+            alt = plain_texture(level);
+        }
+        return *alt;
+    };
+    for (const auto& m : materials) {
+        _materials.emplace_back(texture(m.tex_diffuse, white, 255),
+                                texture(m.tex_specular, black, 0),
+                                m.shininess);
+    }
+    _stats.textures = _textures.size();
+
+    // the gpu has them now.
+    vertices = {};
+    indices = {};
+    _cooked_vertices = {};
+    _cooked_indices = {};
+    _cooked = {};
+}
+
+span<const Model::vertex> Model::vertex_data() const
+{
+    return _cooked ? _cooked_vertices : span<const vertex>{vertices};
+}
+
+span<const uint32_t> Model::index_data() const
+{
+    return _cooked ? _cooked_indices : span<const uint32_t>{indices};
+}
+
+size_t Model::material_key(uint32_t i) const
+{
+    const auto& mat = _materials[i];
+    size_t seed = 0;
+    boost::hash_combine(seed, mat.diffuse.id());
+    boost::hash_combine(seed, mat.specular.id());
+    boost::hash_combine(seed, mat.shine);
+    return seed;
+}
+
+// =====[cooked models]=====
+
+namespace {
+constexpr uint32_t cooked_magic = 0x48534D48; // "HMSH"
+constexpr uint32_t cooked_version = 3;
+// sections start aligned to this, so mapped arrays can be used in place.
+constexpr size_t cooked_align = 16;
+
+struct cooked_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertices;
+    uint32_t indices;
+    uint32_t submeshes;
+    uint32_t lods;
+    uint32_t materials;
+    // bytes of link text.
+    uint32_t strings;
+    aabb box;
+};
+
+struct cooked_material {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+    // link text offsets and lengths, 0 length for none.
+    uint32_t diffuse_at;
+    uint32_t diffuse_len;
+    uint32_t specular_at;
+    uint32_t specular_len;
+};
+
+constexpr size_t align_up(size_t n)
+{
+    return (n + cooked_align - 1) / cooked_align * cooked_align;
+}
+
+// byte offsets of each section of a cooked file.
+struct cooked_layout {
+    size_t vertices, indices, submeshes, lods, materials, strings, end;
+
+    explicit cooked_layout(const cooked_header& h)
+    {
+        vertices = align_up(sizeof(cooked_header));
+        indices = align_up(vertices + h.vertices * sizeof(Model::vertex));
+        submeshes = align_up(indices + h.indices * sizeof(uint32_t));
+        lods = align_up(submeshes + h.submeshes * sizeof(Model::submesh));
+        materials = align_up(lods + h.lods * sizeof(Model::lod));
+        strings =
+            align_up(materials + h.materials * sizeof(cooked_material));
+        end = strings + h.strings;
+    }
+};
+
+// hashes a word at a time, which matters for large sources.
+size_t hash_bytes(span<const unsigned char> bytes)
+{
+    size_t seed = bytes.size();
+    size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t w;
+        std::memcpy(&w, bytes.data() + i, sizeof(w));
+        boost::hash_combine(seed, w);
+    }
+    for (; i < bytes.size(); ++i) {
+        boost::hash_combine(seed, bytes[i]);
+    }
+    return seed;
+}
+
+// decodes the textures of `m` into the image cache, off the main thread.
+// links that fail to decode are cleared, so `upload` gives their materials a
+// plain texture rather than a placeholder that never loads.
+void prefetch_textures(Model& m)
+{
+    vector<link> textures;
+    // index of each distinct texture in `textures`.
+    hash_map<path, size_t> seen;
+    for (const auto& mat : m.materials) {
+        for (const auto* l : {&mat.tex_diffuse, &mat.tex_specular}) {
+            if (*l && seen.try_emplace((**l).resolve(), textures.size())
+                          .second) {
+                textures.push_back(**l);
+            }
+        }
+    }
+    vector<char> failed(textures.size(), false);
+    tbb::parallel_for(size_t{0}, textures.size(), [&](size_t i) {
+        try {
+            assets::get<image_data>(textures[i]);
+        }
+        catch (const std::exception&) {
+            LOG_WARNING("cannot decode texture: {}", textures[i]);
+            failed[i] = true;
+        }
+    });
+    for (auto& mat : m.materials) {
+        for (auto* l : {&mat.tex_diffuse, &mat.tex_specular}) {
+            if (*l && failed[seen.at((**l).resolve())]) {
+                l->reset();
+            }
+        }
+    }
+}
+
+// names the cooked file, so a changed source or format misses the cache.
+size_t cooked_key(const link& src)
+{
+    size_t key = hash_bytes(src.read().bytes());
+    boost::hash_combine(key, import_flags);
+    boost::hash_combine(key, cooked_version);
+    boost::hash_combine(key, sizeof(Model::vertex));
+    return key;
+}
+} // namespace
+
+path asset<Model>::cooked_path(const link& src)
+{
+    return get_local_dir() / "cache" /
+           fmt::format("mesh-{:016x}.bin", cooked_key(src));
+}
+
+void asset<Model>::cook(const Model& m, const path& file)
+{
+    const auto verts = m.vertex_data();
+    const auto idx = m.index_data();
+
+    string strings;
+    vector<cooked_material> mats;
+    auto put = [&](const optional<link>& l, uint32_t& at, uint32_t& len) {
+        at = strings.size();
+        len = 0;
+        if (l) {
+            string_view text = (*l)->buffer();
+            strings.append(text);
+            len = text.size();
+        }
+    };
+    for (const auto& mat : m.materials) {
+        cooked_material rec{.ambient = mat.color_ambient,
+                            .diffuse = mat.color_diffuse,
+                            .specular = mat.color_specular,
+                            .shininess = mat.shininess};
+        put(mat.tex_diffuse, rec.diffuse_at, rec.diffuse_len);
+        put(mat.tex_specular, rec.specular_at, rec.specular_len);
+        mats.push_back(rec);
+    }
+
+    const cooked_header hdr{.magic = cooked_magic,
+                            .version = cooked_version,
+                            .vertices = uint32_t(verts.size()),
+                            .indices = uint32_t(idx.size()),
+                            .submeshes = uint32_t(m.submeshes.size()),
+                            .lods = uint32_t(m.lods.size()),
+                            .materials = uint32_t(mats.size()),
+                            .strings = uint32_t(strings.size()),
+                            .box = m.box};
+    const cooked_layout at{hdr};
+    try {
+        fs::create_directories(file.parent_path());
+        // written aside and renamed, so readers never see a partial file.
+        path tmp = file;
+        tmp += ".tmp";
+        {
+            ofstream out;
+            out.exceptions(ofstream::badbit | ofstream::failbit);
+            out.open(tmp, ios_base::binary | ios_base::trunc);
+            auto write = [&](size_t offset, const void* data, size_t n) {
+                static constexpr char zeros[cooked_align]{};
+                out.write(zeros, offset - size_t(out.tellp()));
+                out.write(static_cast<const char*>(data), n);
+            };
+            write(0, &hdr, sizeof(hdr));
+            write(at.vertices, verts.data(), verts.size_bytes());
+            write(at.indices, idx.data(), idx.size_bytes());
+            write(at.submeshes, m.submeshes.data(),
+                  m.submeshes.size() * sizeof(Model::submesh));
+            write(at.lods, m.lods.data(), m.lods.size() * sizeof(Model::lod));
+            write(at.materials, mats.data(),
+                  mats.size() * sizeof(cooked_material));
+            write(at.strings, strings.data(), strings.size());
+        }
+        fs::rename(tmp, file);
+        LOG_DEBUG("cooked model: {}", file);
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING("cannot write cooked model {}: {}", file, e.what());
+    }
+}
+
+shared_ptr<Model> asset<Model>::load_cooked(const path& file)
+{
+    if (!fs::exists(file)) {
+        return nullptr;
+    }
+    auto obj = std::make_shared<Model>();
+    obj->_cooked = mapped_file{file};
+    const auto bytes = obj->_cooked.bytes();
+
+    cooked_header hdr;
+    if (bytes.size() < sizeof(hdr)) {
+        LOG_WARNING("cooked model {} is truncated", file);
+        return nullptr;
+    }
+    std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+    const cooked_layout at{hdr};
+    if (hdr.magic != cooked_magic || hdr.version != cooked_version ||
+        bytes.size() < at.end) {
+        LOG_WARNING("cooked model {} is malformed", file);
+        return nullptr;
+    }
+
+    // vertices and indices stay in the mapping until uploaded.
+    obj->_cooked_vertices = {
+        reinterpret_cast<const Model::vertex*>(bytes.data() + at.vertices),
+        hdr.vertices};
+    obj->_cooked_indices = {
+        reinterpret_cast<const uint32_t*>(bytes.data() + at.indices),
+        hdr.indices};
+    // a stale or corrupt file must not reach the gpu with stray indices.
+    for (auto i : obj->_cooked_indices) {
+        if (i >= hdr.vertices) {
+            LOG_WARNING("cooked model {} indexes past its vertices", file);
+            return nullptr;
+        }
+    }
+    obj->submeshes.resize(hdr.submeshes);
+    std::memcpy(obj->submeshes.data(), bytes.data() + at.submeshes,
+                hdr.submeshes * sizeof(Model::submesh));
+    obj->lods.resize(hdr.lods);
+    std::memcpy(obj->lods.data(), bytes.data() + at.lods,
+                hdr.lods * sizeof(Model::lod));
+
+    const string_view strings{
+        reinterpret_cast<const char*>(bytes.data() + at.strings),
+        hdr.strings};
+    // false if the range or the link text is bad.
+    auto get = [&](uint32_t offset, uint32_t len, optional<link>& out) {
+        if (len == 0) {
+            out = nullopt;
+            return true;
+        }
+        if (size_t(offset) + len > strings.size()) {
+            return false;
+        }
+        try {
+            out = link{strings.substr(offset, len)};
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    };
+    for (uint32_t i = 0; i < hdr.materials; ++i) {
+        cooked_material rec;
+        std::memcpy(&rec, bytes.data() + at.materials + i * sizeof(rec),
+                    sizeof(rec));
+        auto& mat = obj->materials.emplace_back();
+        mat.color_ambient = rec.ambient;
+        mat.color_diffuse = rec.diffuse;
+        mat.color_specular = rec.specular;
+        mat.shininess = rec.shininess;
+        if (!get(rec.diffuse_at, rec.diffuse_len, mat.tex_diffuse) ||
+            !get(rec.specular_at, rec.specular_len, mat.tex_specular)) {
+            LOG_WARNING("cooked model {} has a bad texture link", file);
+            return nullptr;
+        }
+    }
+    for (const auto& sub : obj->submeshes) {
+        if (sub.material >= obj->materials.size() ||
+            size_t(sub.first) + sub.count > hdr.indices) {
+            LOG_WARNING("cooked model {} is inconsistent", file);
+            return nullptr;
+        }
+    }
+    for (const auto& l : obj->lods) {
+        if (size_t(l.first) + l.count > hdr.submeshes) {
+            LOG_WARNING("cooked model {} is inconsistent", file);
+            return nullptr;
+        }
+    }
+    if (obj->lods.empty()) {
+        LOG_WARNING("cooked model {} is malformed", file);
+        return nullptr;
+    }
+    obj->box = hdr.box;
+
+    auto& st = obj->_stats;
+    st.cooked = true;
+    st.vertices = hdr.vertices;
+    for (const auto& sub : obj->level(0)) {
+        st.triangles += sub.count / 3;
+    }
+    return obj;
+}
+
+// =====[asset<Model>]=====
+
+shared_ptr<Model> asset<Model>::import(const link& pat)
+{
+    LOG_DEBUG("importing model: {}", pat);
+    const auto start = clock::now();
+    auto& importer = get_importer();
+    const aiScene* scene = importer.ReadFile(pat.resolve(), import_flags);
+    if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) ||
+        !scene->mRootNode) {
+        LOG_ERROR("assimp error: {}: {}", pat, importer.GetErrorString());
+        throw runtime_error{"model import failed"};
+    }
+    const auto imported = clock::now();
+
+    auto obj = std::make_shared<Model>();
+    auto& st = obj->_stats;
+    st.import_time = imported - start;
+
+    vector<placement> placed;
+    collect(scene, scene->mRootNode, mat4{1.0}, placed);
+    vector<Mesh> meshes(placed.size());
+    vector<pair<vertex_cache_stats, vertex_cache_stats>> cache(placed.size());
+    tbb::parallel_for(size_t{0}, placed.size(), [&](size_t i) {
+        meshes[i] = Mesh{placed[i].mesh, placed[i].xform};
+        cache[i] = optimize_mesh(meshes[i].indices, meshes[i].vertices);
+    });
+    for (const auto& [before, after] : cache) {
+        st.cache_before += before;
+        st.cache_after += after;
+    }
+
+    for (unsigned i = 0; i < scene->mNumMaterials; ++i) {
+        obj->materials.emplace_back(scene->mMaterials[i], pat);
+    }
+    if (obj->materials.empty()) {
+        obj->materials.emplace_back();
+    }
+    importer.FreeScene();
+    obj->merge(meshes);
+    obj->build_lods(lod_levels, lod_ratio, lod_max_error);
+    st.process_time = clock::now() - imported;
+    return obj;
+}
+
 shared_ptr<Model> asset<Model>::load_from(const link& pat)
 {
-    // link dir = pat.parent_path();
-    // link::push(pat);
-    LOG_DEBUG("loading model: {}", pat);
-    const aiScene* scene = get_importer().ReadFile(
-        pat.resolve(), aiProcess_Triangulate | aiProcess_FlipUVs);
-    LOG_DEBUG("model name: {}", scene->mName.C_Str());
-    LOG_DEBUG("model root name: {}", scene->mRootNode->mName.C_Str());
-    return nullptr;
+    const auto start = clock::now();
+    const path cooked = cooked_path(pat);
+    auto obj = load_cooked(cooked);
+    if (!obj) {
+        obj = import(pat);
+        cook(*obj, cooked);
+    }
+    prefetch_textures(*obj);
+
+    const auto& st = obj->last_stats();
+    if (st.cooked) {
+        LOG_INFO("model {}: cooked, {} vertices, {} triangles, {} draws, "
+                 "loaded in {:.1f} ms",
+                 pat, st.vertices, st.triangles, obj->level(0).size(),
+                 duration<float, std::milli>{clock::now() - start}.count());
+    }
+    else {
+        LOG_INFO("model {}: {} meshes, {} vertices, {} triangles, {} draws, "
+                 "import {:.1f} ms, process {:.1f} ms",
+                 pat, st.meshes, st.vertices, st.triangles,
+                 obj->level(0).size(), st.import_time.count(),
+                 st.process_time.count());
+        LOG_INFO("model {}: acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}", pat,
+                 st.cache_before.acmr(), st.cache_after.acmr(),
+                 st.cache_before.atvr(), st.cache_after.atvr());
+    }
+    // triangles and error of each level of detail.
+    string levels;
+    for (size_t i = 0; i < obj->lods.size(); ++i) {
+        size_t tris = 0;
+        for (const auto& sub : obj->level(i)) {
+            tris += sub.count / 3;
+        }
+        levels += fmt::format("{}{} ({:.3f})", i ? ", " : "", tris,
+                              obj->lods[i].error);
+    }
+    LOG_INFO("model {}: levels of detail {}", pat, levels);
+    return obj;
+}
+
+/*
+ * ==[[Prop]]==
+ */
+
+Prop::Prop(shared_ptr<const Model> src)
+    : Geometry{src->vbuf(), sphere{src->box}},
+      _src{std::move(src)}
+{
+}
+
+void Prop::draw(Frame& f, float alpha) const
+{
+    for (const auto& sub : _src->level(_lod)) {
+        use_material(f, sub.material);
+        draw_submesh(f, sub, alpha);
+    }
+}
+
+void Prop::submit(RenderQueue& q, float alpha) const
+{
+    const vec3 pos = model()[3];
+    const auto vao = q.vao(_vbuf.vao());
+    const auto depth = q.depth(pos);
+    const auto& lod = _src->lods[_lod];
+    for (uint32_t i = lod.first; i < lod.first + lod.count; ++i) {
+        const auto mat = _src->submeshes[i].material;
+        q.push(*this, alpha, q.material(_src->material_key(mat)), vao, depth,
+               i);
+    }
+}
+
+void Prop::execute(Frame& f, const RenderCommand& cmd, bool rebind) const
+{
+    const auto& sub = _src->submeshes[cmd.arg];
+    if (rebind) {
+        use_material(f, sub.material);
+    }
+    draw_submesh(f, sub, cmd.alpha);
+}
+
+void Prop::select_lod(const Camera& cam, const lod_policy& policy)
+{
+    const auto& lods = _src->lods;
+    const sphere s = bounds();
+    const float dist = glm::length(s.center - cam.position());
+    if (lods.size() < 2 || dist <= s.radius) {
+        _lod = 0;
+        return;
+    }
+    // bounding radius projected to pixels.
+    const float px =
+        s.radius * cam.proj()[1][1] / dist * cam.viewport().y * 0.5f;
+    uint32_t next = 0;
+    for (uint32_t i = 1; i < lods.size(); ++i) {
+        // coarsening must clear the limit by a margin, refining need not.
+        float limit = policy.pixel_error;
+        if (i > _lod) {
+            limit *= 1.0f - policy.hysteresis;
+        }
+        if (lods[i].error * px <= limit) {
+            next = i;
+        }
+    }
+    _lod = next;
+}
+
+size_t Prop::triangles() const
+{
+    size_t n = 0;
+    for (const auto& sub : _src->level(_lod)) {
+        n += sub.count / 3;
+    }
+    return n;
+}
+
+void Prop::use_material(Frame& f, uint32_t material) const
+{
+    const auto& shader = f->pipeline();
+    if (_mat_pipeline != &shader) {
+        _mat_uniforms = {shader, "material"};
+        _mat_pipeline = &shader;
+    }
+    const auto& mat = _src->material(material);
+    mat.diffuse.bind(0);
+    mat.specular.bind(1);
+    mat.load_into(_mat_uniforms, shader);
+}
+
+void Prop::draw_submesh(Frame& f, const Model::submesh& sub,
+                        float alpha) const
+{
+    auto& stream = f->stream();
+    geometry_instance inst = instance(alpha);
+    auto offset = stream.write(span{&inst, 1});
+    _vbuf.instances<geometry_instance>(stream.buffer(), offset,
+                                       instance_attrib);
+    _vbuf.draw_range(sub.first, sub.count);
 }
 
 } // namespace hera
@@ -18,14 +18,177 @@
 #define HERA_RENDER_MODEL_HPP
 
 #include <hera/io/assets.hpp>
+#include <hera/io/mapped.hpp>
+#include <hera/gl/buffer.hpp>
+#include <hera/render/bounds.hpp>
+#include <hera/render/camera.hpp>
+#include <hera/render/geometry.hpp>
+#include <hera/render/material.hpp>
+#include <hera/render/mesh.hpp>
+#include <hera/render/optimize.hpp>
 
 namespace hera {
 
-class Model {};
+// an imported model, its meshes merged into one vertex and index buffer.
+//
+// loading builds the merged arrays on the cpu, so it can run off the main
+// thread. `upload` then creates the buffers and textures on the main thread.
+//
+// imports are cooked into a cache file that later loads map and upload
+// directly, skipping assimp.
+//
+// simplified levels of detail share the vertex buffer, each indexing a
+// subset of the vertices through its own submeshes.
+class Model {
+public:
+    using vertex = Mesh::vertex;
+
+    // a run of indices sharing one material.
+    struct submesh {
+        uint32_t first;
+        uint32_t count;
+        uint32_t material;
+    };
+
+    // a level of detail, as a run of `submeshes`.
+    struct lod {
+        uint32_t first;
+        uint32_t count;
+        // largest surface deviation from the full model, as a fraction of
+        // the bounding radius.
+        float error;
+    };
+
+    struct stats {
+        size_t meshes = 0;
+        size_t vertices = 0;
+        size_t triangles = 0;
+        // distinct textures after deduplication.
+        size_t textures = 0;
+        duration<float, std::milli> import_time{0};
+        duration<float, std::milli> process_time{0};
+        // loaded from a cooked file rather than imported.
+        bool cooked = false;
+        // vertex cache behaviour of the imported index order, and after
+        // optimizing it. empty for cooked models.
+        vertex_cache_stats cache_before;
+        vertex_cache_stats cache_after;
+    };
+
+    // merged geometry of imported models, dropped once uploaded.
+    vector<vertex> vertices;
+    vector<uint32_t> indices;
+    // ordered by material, one per material in use, for each level of
+    // detail in turn.
+    vector<submesh> submeshes;
+    // finest first. the first level is the merged model itself.
+    vector<lod> lods;
+    vector<Material> materials;
+    aabb box;
+
+    // merges `meshes` into one buffer, grouping them by material.
+    void merge(span<const Mesh> meshes);
+    // simplifies the merged model into up to `levels` levels of detail, each
+    // with about `ratio` of the triangles of the one before. call after the
+    // last merge.
+    void build_lods(size_t levels, float ratio, float max_error);
+
+    // submeshes of level of detail `i`.
+    span<const submesh> level(size_t i) const
+    {
+        return span{submeshes}.subspan(lods[i].first, lods[i].count);
+    }
+
+    // merged geometry, in `vertices` and `indices` or a cooked mapping.
+    span<const vertex> vertex_data() const;
+    span<const uint32_t> index_data() const;
+
+    // creates the gpu buffers, and textures whose images are uploaded by
+    // later finalize jobs. main thread only.
+    void upload();
+    bool uploaded() const { return _vbuf.has_value(); }
+
+    const gl::VertexBuffer& vbuf() const { return *_vbuf; }
+    // gpu material of each entry of `materials`.
+    const Material2& material(uint32_t i) const { return _materials[i]; }
+    // hash of a material's gpu state, for render queue keys.
+    size_t material_key(uint32_t i) const;
+
+    const stats& last_stats() const { return _stats; }
+
+private:
+    friend struct asset<Model>;
+
+    // cooked file viewed by `vertex_data` and `index_data`, if any.
+    mapped_file _cooked;
+    span<const vertex> _cooked_vertices;
+    span<const uint32_t> _cooked_indices;
+
+    optional<gl::VertexBuffer> _vbuf;
+    vector<Material2> _materials;
+    // keeps the shared textures alive in the asset cache.
+    vector<shared_ptr<gl::Texture2d>> _textures;
+    stats _stats;
+};
 
 template<>
 struct asset<Model> {
-    shared_ptr<Model> load_from(const link&);
+    // loads the cooked form of `src` if it is current, otherwise imports and
+    // cooks it.
+    shared_ptr<Model> load_from(const link& src);
+
+    // imports with assimp, bypassing the cooked cache.
+    static shared_ptr<Model> import(const link& src);
+    // cooked file of `src`. it changes with the contents of `src` and the
+    // import settings.
+    static path cooked_path(const link& src);
+    // writes the cooked form of an imported model to `file`.
+    static void cook(const Model& m, const path& file);
+    // maps a cooked file. null if it is missing or malformed.
+    static shared_ptr<Model> load_cooked(const path& file);
+};
+
+// when props switch between levels of detail.
+struct lod_policy {
+    // simplification error allowed on screen, in pixels.
+    float pixel_error = 1.0f;
+    // a coarser level must beat `pixel_error` by this fraction, so props
+    // near a switching distance don't flicker between levels.
+    float hysteresis = 0.25f;
+};
+
+// a placed instance of a model.
+//
+// queues one command per submesh, so the render queue groups the submeshes
+// of every prop by material and vertex array.
+class Prop : public Geometry {
+    shared_ptr<const Model> _src;
+    uint32_t _lod = 0;
+    // material handles and the pipeline they were resolved in.
+    mutable Material2::uniforms _mat_uniforms;
+    mutable const gl::Pipeline* _mat_pipeline = nullptr;
+
+public:
+    // `src` must be uploaded.
+    explicit Prop(shared_ptr<const Model> src);
+
+    void draw(Frame& f, float alpha) const override;
+    void submit(RenderQueue& q, float alpha) const override;
+    void execute(Frame& f, const RenderCommand& cmd,
+                 bool rebind) const override;
+
+    const Model& source() const { return *_src; }
+
+    // picks the level of detail for the projected size of the prop.
+    void select_lod(const Camera& cam, const lod_policy& policy);
+    void reset_lod() { _lod = 0; }
+    uint32_t lod() const { return _lod; }
+    // triangles drawn at the current level of detail.
+    size_t triangles() const;
+
+private:
+    void use_material(Frame& f, uint32_t material) const;
+    void draw_submesh(Frame& f, const Model::submesh& sub, float alpha) const;
 };
 
 } // namespace hera
@@ -0,0 +1,501 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <hera/render/optimize.hpp>
+
+namespace hera {
+
+vertex_cache_stats analyze_cache(span<const uint32_t> indices,
+                                 size_t vertex_count, size_t cache_size)
+{
+    vertex_cache_stats st{.triangles = indices.size() / 3,
+                          .vertices = vertex_count};
+    // a vertex is cached while fewer than `cache_size` misses followed it.
+    vector<size_t> stamp(vertex_count, 0);
+    size_t time = cache_size + 1;
+    for (auto v : indices) {
+        if (time - stamp[v] > cache_size) {
+            stamp[v] = time++;
+            ++st.transformed;
+        }
+    }
+    return st;
+}
+
+vector<uint32_t> optimize_cache(span<uint32_t> indices, size_t vertex_count,
+                                size_t cache_size)
+{
+    const size_t tris = indices.size() / 3;
+    vector<uint32_t> clusters;
+    if (tris == 0) {
+        return clusters;
+    }
+
+    // triangles still to be emitted around each vertex.
+    vector<uint32_t> live(vertex_count, 0);
+    for (size_t i = 0; i < tris * 3; ++i) {
+        ++live[indices[i]];
+    }
+    // triangles around vertex v are adjacent[offsets[v]..offsets[v + 1]).
+    vector<uint32_t> offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    vector<uint32_t> adjacent(tris * 3);
+    {
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < tris; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                adjacent[fill[indices[t * 3 + k]]++] = t;
+            }
+        }
+    }
+
+    vector<size_t> stamp(vertex_count, 0);
+    size_t time = cache_size + 1;
+    vector<bool> emitted(tris, false);
+    vector<uint32_t> dead_end;
+    vector<uint32_t> candidates;
+    vector<uint32_t> out;
+    out.reserve(tris * 3);
+    size_t cursor = 0;
+
+    // a recently used vertex with triangles left, or failing that the next
+    // one in input order.
+    auto skip_dead_end = [&] -> int64_t {
+        while (!dead_end.empty()) {
+            const uint32_t v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0) {
+                return v;
+            }
+        }
+        for (; cursor < vertex_count; ++cursor) {
+            if (live[cursor] > 0) {
+                return cursor;
+            }
+        }
+        return -1;
+    };
+
+    int64_t fan = skip_dead_end();
+    clusters.push_back(0);
+    while (fan >= 0) {
+        candidates.clear();
+        for (auto j = offsets[fan]; j < offsets[fan + 1]; ++j) {
+            const uint32_t t = adjacent[j];
+            if (emitted[t]) {
+                continue;
+            }
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t v = indices[t * 3 + k];
+                out.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - stamp[v] > cache_size) {
+                    stamp[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        // fan next around the candidate that stays cached the longest.
+        int64_t next = -1;
+        int64_t best = -1;
+        for (auto v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            int64_t p = 0;
+            if (time - stamp[v] + 2 * live[v] <= cache_size) {
+                p = time - stamp[v];
+            }
+            if (p > best) {
+                best = p;
+                next = v;
+            }
+        }
+        if (next < 0) {
+            next = skip_dead_end();
+            const uint32_t at = out.size() / 3;
+            if (next >= 0 && at != clusters.back()) {
+                clusters.push_back(at);
+            }
+        }
+        fan = next;
+    }
+
+    std::copy(out.begin(), out.end(), indices.begin());
+    return clusters;
+}
+
+void order_clusters(span<uint32_t> indices, span<const vec3> positions,
+                    span<const uint32_t> clusters, size_t cache_size,
+                    float threshold)
+{
+    const size_t tris = indices.size() / 3;
+    if (clusters.empty() || tris == 0) {
+        return;
+    }
+    auto cluster_end = [&](size_t c) -> size_t {
+        return c + 1 < clusters.size() ? clusters[c + 1] : tris;
+    };
+
+    // split the hard clusters wherever a fresh cache would already do about
+    // as well as the whole cluster, so there is more to sort.
+    vector<uint32_t> soft;
+    // shared by every cluster, bumping `time` past the cache size empties it.
+    vector<size_t> stamp(positions.size(), 0);
+    size_t time = cache_size + 1;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const size_t first = clusters[c];
+        const size_t last = cluster_end(c);
+        size_t whole = 0;
+        time += cache_size + 1;
+        for (size_t i = first * 3; i < last * 3; ++i) {
+            const auto v = indices[i];
+            if (time - stamp[v] > cache_size) {
+                stamp[v] = time++;
+                ++whole;
+            }
+        }
+        const float limit = float(whole) / (last - first) * threshold;
+
+        soft.push_back(first);
+        size_t start = first;
+        size_t misses = 0;
+        time += cache_size + 1;
+        for (size_t t = first; t < last; ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                const auto v = indices[t * 3 + k];
+                if (time - stamp[v] > cache_size) {
+                    stamp[v] = time++;
+                    ++misses;
+                }
+            }
+            const size_t n = t + 1 - start;
+            if (t + 1 < last && float(misses) / n <= limit) {
+                soft.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                // the next cluster may draw after any other.
+                time += cache_size + 1;
+            }
+        }
+    }
+
+    // area-weighted centroid and normal of a triangle range.
+    struct facing {
+        vec3 centroid{0};
+        vec3 normal{0};
+        float area = 0;
+    };
+    auto face = [&](size_t first, size_t last) -> facing {
+        facing f;
+        for (size_t t = first; t < last; ++t) {
+            const vec3& a = positions[indices[t * 3]];
+            const vec3& b = positions[indices[t * 3 + 1]];
+            const vec3& c = positions[indices[t * 3 + 2]];
+            const vec3 n = glm::cross(b - a, c - a);
+            const float area = glm::length(n);
+            f.centroid += (a + b + c) / 3.0f * area;
+            f.normal += n;
+            f.area += area;
+        }
+        if (f.area > 0) {
+            f.centroid /= f.area;
+        }
+        return f;
+    };
+
+    const facing mesh = face(0, tris);
+    const auto old = analyze_cache(indices, positions.size(), cache_size);
+
+    // sorts the clusters starting at `bounds`, if the cache can afford it.
+    auto reorder = [&](span<const uint32_t> bounds) -> bool {
+        auto end = [&](size_t c) -> size_t {
+            return c + 1 < bounds.size() ? bounds[c + 1] : tris;
+        };
+        vector<pair<float, uint32_t>> order;
+        order.reserve(bounds.size());
+        for (size_t c = 0; c < bounds.size(); ++c) {
+            const facing f = face(bounds[c], end(c));
+            const float len = glm::length(f.normal);
+            const float key =
+                len > 0 ? glm::dot(f.centroid - mesh.centroid, f.normal) / len
+                        : 0.0f;
+            order.emplace_back(key, c);
+        }
+        // clusters facing out from the centre are the likeliest occluders.
+        std::stable_sort(order.begin(), order.end(),
+                         [](const auto& a, const auto& b) {
+                             return a.first > b.first;
+                         });
+
+        vector<uint32_t> out;
+        out.reserve(tris * 3);
+        for (const auto& [_, c] : order) {
+            out.insert(out.end(), indices.begin() + bounds[c] * 3,
+                       indices.begin() + end(c) * 3);
+        }
+        const auto now = analyze_cache(out, positions.size(), cache_size);
+        if (now.transformed > old.transformed * threshold) {
+            return false;
+        }
+        std::copy(out.begin(), out.end(), indices.begin());
+        return true;
+    };
+
+    // finer clusters sort better but cost more cache misses.
+    if (!reorder(soft)) {
+        reorder(clusters);
+    }
+}
+
+namespace {
+// symmetric 4x4 matrix summing squared distances to a set of planes.
+struct quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+
+    // the plane through `p` with unit normal `n`.
+    static quadric plane(const vec3& n, const vec3& p)
+    {
+        const double a = n.x, b = n.y, c = n.z;
+        const double d = -glm::dot(n, p);
+        return {a * a, a * b, a * c, a * d, b * b, b * c,
+                b * d, c * c, c * d, d * d};
+    }
+
+    quadric& operator+=(const quadric& q)
+    {
+        a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+        a11 += q.a11, a12 += q.a12, a13 += q.a13;
+        a22 += q.a22, a23 += q.a23;
+        a33 += q.a33;
+        return *this;
+    }
+
+    double eval(const vec3& p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        const double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z +
+                         2 * a03 * x + a11 * y * y + 2 * a12 * y * z +
+                         2 * a13 * y + a22 * z * z + 2 * a23 * z + a33;
+        return std::max(e, 0.0);
+    }
+};
+
+struct collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+uint64_t edge_key(uint32_t a, uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+} // namespace
+
+vector<uint32_t> simplify(span<const uint32_t> indices,
+                          span<const vec3> positions, size_t target,
+                          float max_error, float& error)
+{
+    vector<uint32_t> tris(indices.begin(),
+                          indices.begin() + indices.size() / 3 * 3);
+    error = 0;
+    if (tris.size() <= target) {
+        return tris;
+    }
+    const size_t n = positions.size();
+    const double limit = double(max_error) * max_error;
+
+    vector<quadric> quadrics(n);
+    // vertices that must not move.
+    vector<uint8_t> locked(n, 0);
+    {
+        hash_map<uint64_t, uint32_t> edges;
+        for (size_t t = 0; t < tris.size(); t += 3) {
+            const uint32_t v[3] = {tris[t], tris[t + 1], tris[t + 2]};
+            const vec3 normal =
+                glm::cross(positions[v[1]] - positions[v[0]],
+                           positions[v[2]] - positions[v[0]]);
+            const float len = glm::length(normal);
+            for (size_t k = 0; k < 3; ++k) {
+                if (len > 0) {
+                    quadrics[v[k]] += quadric::plane(normal / len,
+                                                     positions[v[0]]);
+                }
+                ++edges[edge_key(v[k], v[(k + 1) % 3])];
+            }
+        }
+        // an edge without exactly two faces is a border.
+        for (const auto& [key, count] : edges) {
+            if (count != 2) {
+                locked[key >> 32] = 1;
+                locked[key & 0xFFFFFFFF] = 1;
+            }
+        }
+        // split vertices sharing a position are seams in some attribute.
+        vector<uint32_t> used(tris);
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        auto by_position = [&](uint32_t a, uint32_t b) {
+            const vec3& p = positions[a];
+            const vec3& q = positions[b];
+            return tuple{p.x, p.y, p.z} < tuple{q.x, q.y, q.z};
+        };
+        std::sort(used.begin(), used.end(), by_position);
+        for (size_t i = 1; i < used.size(); ++i) {
+            if (positions[used[i - 1]] == positions[used[i]]) {
+                locked[used[i - 1]] = 1;
+                locked[used[i]] = 1;
+            }
+        }
+    }
+
+    vector<uint32_t> remap(n);
+    vector<uint8_t> touched(n);
+    vector<collapse> candidates;
+    vector<uint32_t> offsets(n + 1);
+    vector<uint32_t> adjacent;
+    double worst = 0;
+
+    while (tris.size() > target) {
+        candidates.clear();
+        for (size_t t = 0; t < tris.size(); t += 3) {
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t a = tris[t + k];
+                const uint32_t b = tris[t + (k + 1) % 3];
+                for (auto [u, v] : {pair{a, b}, pair{b, a}}) {
+                    if (locked[u]) {
+                        continue;
+                    }
+                    quadric q = quadrics[u];
+                    q += quadrics[v];
+                    const double cost = q.eval(positions[v]);
+                    if (cost <= limit) {
+                        candidates.push_back({u, v, cost});
+                    }
+                }
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto& a, const auto& b) {
+                      return a.cost < b.cost;
+                  });
+
+        // triangles around each vertex, for the flip test.
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (auto v : tris) {
+            ++offsets[v + 1];
+        }
+        for (size_t v = 0; v < n; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacent.resize(tris.size());
+        {
+            vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < tris.size(); ++i) {
+                adjacent[fill[tris[i]]++] = i / 3;
+            }
+        }
+
+        for (size_t v = 0; v < n; ++v) {
+            remap[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+        // each collapse removes about two triangles.
+        const size_t wanted = (tris.size() - target) / 3;
+        size_t removed = 0;
+        for (const auto& c : candidates) {
+            if (removed >= wanted) {
+                break;
+            }
+            if (touched[c.from] || touched[c.to]) {
+                continue;
+            }
+            // moving `from` must not turn any remaining face over.
+            bool flips = false;
+            for (auto j = offsets[c.from]; j < offsets[c.from + 1]; ++j) {
+                const size_t t = adjacent[j] * 3;
+                vec3 p[3];
+                bool shared = false;
+                for (size_t k = 0; k < 3; ++k) {
+                    shared |= tris[t + k] == c.to;
+                    p[k] = positions[tris[t + k]];
+                }
+                if (shared) {
+                    continue;
+                }
+                const vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                for (size_t k = 0; k < 3; ++k) {
+                    if (tris[t + k] == c.from) {
+                        p[k] = positions[c.to];
+                    }
+                }
+                const vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                if (glm::dot(before, after) <= 0) {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips) {
+                continue;
+            }
+            remap[c.from] = c.to;
+            quadrics[c.to] += quadrics[c.from];
+            worst = std::max(worst, c.cost);
+            // neighbours are frozen too, so later flip tests stay valid.
+            for (auto j = offsets[c.from]; j < offsets[c.from + 1]; ++j) {
+                const size_t t = adjacent[j] * 3;
+                for (size_t k = 0; k < 3; ++k) {
+                    touched[tris[t + k]] = 1;
+                }
+            }
+            touched[c.to] = 1;
+            removed += 2;
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        size_t out = 0;
+        for (size_t t = 0; t < tris.size(); t += 3) {
+            const uint32_t a = remap[tris[t]];
+            const uint32_t b = remap[tris[t + 1]];
+            const uint32_t c = remap[tris[t + 2]];
+            if (a == b || b == c || c == a) {
+                continue;
+            }
+            tris[out++] = a;
+            tris[out++] = b;
+            tris[out++] = c;
+        }
+        tris.resize(out);
+    }
+    error = std::sqrt(worst);
+    return tris;
+}
+
+} // namespace hera
@@ -0,0 +1,139 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_OPTIMIZE_HPP
+#define HERA_RENDER_OPTIMIZE_HPP
+
+#include <cstring>
+
+#include <hera/common.hpp>
+#include <hera/gl/vertex.hpp>
+
+namespace hera {
+
+// entries in the simulated post-transform cache.
+inline constexpr size_t vertex_cache_size = 16;
+
+// how an index order fares in a fifo post-transform cache.
+struct vertex_cache_stats {
+    size_t transformed = 0;
+    size_t triangles = 0;
+    size_t vertices = 0;
+
+    // average cache miss ratio: transforms per triangle, 0.5 at best.
+    float acmr() const
+    {
+        return triangles ? float(transformed) / triangles : 0.0f;
+    }
+    // average transform to vertex ratio: 1.0 at best.
+    float atvr() const
+    {
+        return vertices ? float(transformed) / vertices : 0.0f;
+    }
+
+    vertex_cache_stats& operator+=(const vertex_cache_stats& rhs)
+    {
+        transformed += rhs.transformed;
+        triangles += rhs.triangles;
+        vertices += rhs.vertices;
+        return *this;
+    }
+};
+
+// simulates a fifo cache of `cache_size` entries over `indices`.
+vertex_cache_stats analyze_cache(span<const uint32_t> indices,
+                                 size_t vertex_count,
+                                 size_t cache_size = vertex_cache_size);
+
+// reorders triangles for cache locality with tipsify (sander et al. 2007).
+// returns the first triangle of each cluster, split where the walk had to
+// jump to a dead-end vertex.
+vector<uint32_t> optimize_cache(span<uint32_t> indices, size_t vertex_count,
+                                size_t cache_size = vertex_cache_size);
+
+// reorders whole clusters so outward-facing ones draw first, occluding the
+// rest. the new order is kept only if its acmr stays within `threshold` of
+// the old one.
+void order_clusters(span<uint32_t> indices, span<const vec3> positions,
+                    span<const uint32_t> clusters,
+                    size_t cache_size = vertex_cache_size,
+                    float threshold = 1.05f);
+
+// simplifies a triangle list to about `target` indices by collapsing edges
+// in order of quadric error (garland and heckbert 1997), stopping early once
+// a collapse would move the surface more than `max_error`. vertices move onto
+// their neighbours, so the result indexes the same vertices. open borders and
+// attribute seams are kept in place. `error` receives the largest error
+// accepted.
+vector<uint32_t> simplify(span<const uint32_t> indices,
+                          span<const vec3> positions, size_t target,
+                          float max_error, float& error);
+
+// positions of a vertex range, taking the first attribute as the position.
+template<spanner R>
+    requires gl::is_vertex<range_v<R>>
+vector<vec3> positions_of(const R& vertices)
+{
+    using pos_type = std::tuple_element_t<0, range_v<R>>;
+    static_assert(sizeof(pos_type) == sizeof(vec3),
+                  "vertex position must be 3 floats");
+    vector<vec3> out;
+    out.reserve(std::ranges::size(vertices));
+    for (const auto& v : vertices) {
+        vec3 p;
+        std::memcpy(&p, &get<0>(v), sizeof(p));
+        out.push_back(p);
+    }
+    return out;
+}
+
+// orders vertices by first use and rewrites `indices` to match, so fetches
+// walk memory forward. unreferenced vertices are dropped.
+template<typename V>
+    requires gl::is_vertex<V>
+void optimize_fetch(span<uint32_t> indices, vector<V>& vertices)
+{
+    constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+    vector<uint32_t> remap(vertices.size(), unused);
+    vector<V> out;
+    out.reserve(vertices.size());
+    for (auto& i : indices) {
+        if (remap[i] == unused) {
+            remap[i] = out.size();
+            out.push_back(vertices[i]);
+        }
+        i = remap[i];
+    }
+    vertices = std::move(out);
+}
+
+// runs every stage over one indexed mesh, returning the cache behaviour
+// before and after.
+template<typename V>
+    requires gl::is_vertex<V>
+pair<vertex_cache_stats, vertex_cache_stats>
+optimize_mesh(vector<uint32_t>& indices, vector<V>& vertices)
+{
+    const auto before = analyze_cache(indices, vertices.size());
+    const auto clusters = optimize_cache(indices, vertices.size());
+    order_clusters(indices, positions_of(vertices), clusters);
+    optimize_fetch(span{indices}, vertices);
+    return {before, analyze_cache(indices, vertices.size())};
+}
+
+} // namespace hera
+
+#endif
@@ -0,0 +1,125 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <hera/render/queue.hpp>
+
+namespace hera {
+
+namespace {
+// counts the key fields that differ between consecutive commands.
+RenderQueue::changes count_changes(span<const RenderCommand> cmds)
+{
+    RenderQueue::changes c;
+    for (size_t i = 1; i < cmds.size(); ++i) {
+        auto prev = cmds[i - 1].key;
+        auto cur = cmds[i].key;
+        c.pipeline += sort_key::pipeline(prev) != sort_key::pipeline(cur);
+        c.material += sort_key::material(prev) != sort_key::material(cur);
+        c.vao += sort_key::vao(prev) != sort_key::vao(cur);
+    }
+    return c;
+}
+} // namespace
+
+void RenderQueue::use(const gl::Pipeline& p)
+{
+    auto it = ranges::find(_pipelines, &p);
+    if (it == _pipelines.end()) {
+        if (_pipelines.size() > sort_key::pipeline_mask) {
+            throw hera::runtime_error("too many pipelines in render queue");
+        }
+        it = _pipelines.insert(it, &p);
+    }
+    _pipeline = std::distance(_pipelines.begin(), it);
+}
+
+uint32_t RenderQueue::material(size_t key)
+{
+    if (auto it = _materials.find(key); it != _materials.end()) {
+        return it->second;
+    }
+    // id 0 is reserved for commands without a material. queued commands keep
+    // their ids, so a full map is only reset between frames.
+    if (_materials.size() + 1 >= sort_key::unique_material) {
+        return sort_key::unique_material;
+    }
+    return _materials.try_emplace(key, _materials.size() + 1).first->second;
+}
+
+uint32_t RenderQueue::vao(gl::id::varray v)
+{
+    if (auto it = _vaos.find(v); it != _vaos.end()) {
+        return it->second;
+    }
+    if (_vaos.size() + 1 >= sort_key::unique_vao) {
+        return sort_key::unique_vao;
+    }
+    return _vaos.try_emplace(v, _vaos.size() + 1).first->second;
+}
+
+uint32_t RenderQueue::depth(const vec3& pos) const
+{
+    float d = std::clamp(glm::distance(pos, _eye) / _zfar, 0.0f, 1.0f);
+    return d * sort_key::depth_mask;
+}
+
+// lsd radix sort on the key, one byte per pass. passes over a byte that is
+// equal in every key are skipped, which is most of them in practice.
+void RenderQueue::sort()
+{
+    const size_t n = _cmds.size();
+    _stats.commands = n;
+    _stats.unsorted = count_changes(_cmds);
+    if (n < 2) {
+        _stats.sorted = _stats.unsorted;
+        return;
+    }
+
+    _scratch.resize(n);
+    for (int shift = 0; shift < 64; shift += 8) {
+        array<size_t, 256> offsets{};
+        for (const auto& cmd : _cmds) {
+            ++offsets[(cmd.key >> shift) & 0xff];
+        }
+        if (offsets[(_cmds.front().key >> shift) & 0xff] == n) {
+            continue;
+        }
+        size_t sum = 0;
+        for (auto& off : offsets) {
+            sum += std::exchange(off, sum);
+        }
+        for (const auto& cmd : _cmds) {
+            _scratch[offsets[(cmd.key >> shift) & 0xff]++] = cmd;
+        }
+        _cmds.swap(_scratch);
+    }
+    _stats.sorted = count_changes(_cmds);
+}
+
+void RenderQueue::clear()
+{
+    _cmds.clear();
+    if (_materials.size() + 1 >= sort_key::unique_material) {
+        _materials.clear();
+    }
+    if (_vaos.size() + 1 >= sort_key::unique_vao) {
+        _vaos.clear();
+    }
+    _pipeline = 0;
+    _layer = 0;
+}
+
+} // namespace hera
@@ -0,0 +1,180 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HERA_RENDER_QUEUE_HPP
+#define HERA_RENDER_QUEUE_HPP
+
+#include <hera/common.hpp>
+#include <hera/gl/program.hpp>
+
+namespace hera {
+
+class Drawable;
+
+// 64-bit command sort key. fields from most to least significant:
+//
+//   layer:4 | pipeline:8 | material:20 | vao:16 | depth:16
+//
+// sorting on the key groups commands by pipeline, then material, then vertex
+// array, and draws each group front to back.
+struct sort_key {
+    static constexpr int depth_shift = 0;
+    static constexpr int vao_shift = 16;
+    static constexpr int material_shift = 32;
+    static constexpr int pipeline_shift = 52;
+    static constexpr int layer_shift = 60;
+
+    static constexpr uint64_t depth_mask = (1ull << 16) - 1;
+    static constexpr uint64_t vao_mask = (1ull << 16) - 1;
+    static constexpr uint64_t material_mask = (1ull << 20) - 1;
+    static constexpr uint64_t pipeline_mask = (1ull << 8) - 1;
+    static constexpr uint64_t layer_mask = (1ull << 4) - 1;
+
+    // handed out once the material ids of a frame run out. commands with it
+    // never share material state, so they always rebind.
+    static constexpr uint32_t unique_material = material_mask;
+    // likewise for vertex arrays, which are only sorted on.
+    static constexpr uint32_t unique_vao = vao_mask;
+
+    static constexpr uint64_t make(uint64_t layer, uint64_t pipeline,
+                                   uint64_t material, uint64_t vao,
+                                   uint64_t depth)
+    {
+        return ((layer & layer_mask) << layer_shift) |
+               ((pipeline & pipeline_mask) << pipeline_shift) |
+               ((material & material_mask) << material_shift) |
+               ((vao & vao_mask) << vao_shift) |
+               ((depth & depth_mask) << depth_shift);
+    }
+
+    static constexpr uint32_t pipeline(uint64_t key)
+    {
+        return (key >> pipeline_shift) & pipeline_mask;
+    }
+    static constexpr uint32_t material(uint64_t key)
+    {
+        return (key >> material_shift) & material_mask;
+    }
+    static constexpr uint32_t vao(uint64_t key)
+    {
+        return (key >> vao_shift) & vao_mask;
+    }
+};
+
+// a deferred draw.
+struct RenderCommand {
+    uint64_t key;
+    const Drawable* drawable;
+    // drawable-defined payload.
+    uint32_t arg;
+    float alpha;
+};
+
+static_assert(std::is_trivially_copyable_v<RenderCommand>);
+
+// collects the commands of a frame and sorts them to minimize state changes.
+class RenderQueue {
+public:
+    // state changes between consecutive commands.
+    struct changes {
+        size_t pipeline = 0;
+        size_t material = 0;
+        size_t vao = 0;
+
+        size_t total() const { return pipeline + material + vao; }
+    };
+
+    struct stats {
+        size_t commands = 0;
+        // in submission order.
+        changes unsorted;
+        // in sorted order.
+        changes sorted;
+
+        // state changes avoided by sorting.
+        size_t saved() const { return unsorted.total() - sorted.total(); }
+    };
+
+private:
+    vector<RenderCommand> _cmds;
+    vector<RenderCommand> _scratch;
+
+    // compact ids for the fields of the sort key.
+    vector<const gl::Pipeline*> _pipelines;
+    hash_map<size_t, uint32_t> _materials;
+    hash_map<GLuint, uint32_t> _vaos;
+
+    uint32_t _pipeline = 0;
+    uint32_t _layer = 0;
+    vec3 _eye{0};
+    float _zfar = 100;
+
+    stats _stats;
+
+public:
+    RenderQueue() = default;
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // sets the pipeline of subsequent commands.
+    void use(const gl::Pipeline&);
+    // sets the layer of subsequent commands. lower layers draw first.
+    void layer(uint32_t l) { _layer = l; }
+    // sets the eye position and range used for depth keys.
+    void eye(const vec3& pos, float zfar)
+    {
+        _eye = pos;
+        _zfar = zfar;
+    }
+
+    // compact material id for a material key, e.g. Geometry::batch_key().
+    // ids stay fixed until `clear`, past which `sort_key::unique_material`
+    // is returned.
+    uint32_t material(size_t key);
+    // compact id for a vertex array.
+    uint32_t vao(gl::id::varray);
+    // quantized distance from the eye.
+    uint32_t depth(const vec3& pos) const;
+
+    void push(const Drawable& d, float alpha, uint32_t material = 0,
+              uint32_t vao = 0, uint32_t depth = 0, uint32_t arg = 0)
+    {
+        _cmds.push_back({
+            .key = sort_key::make(_layer, _pipeline, material, vao, depth),
+            .drawable = &d,
+            .arg = arg,
+            .alpha = alpha,
+        });
+    }
+
+    const gl::Pipeline& pipeline(uint32_t id) const { return *_pipelines[id]; }
+
+    // sorts the queued commands by key and updates the stats.
+    void sort();
+    // drops all queued commands.
+    void clear();
+
+    span<const RenderCommand> commands() const { return _cmds; }
+    size_t size() const { return _cmds.size(); }
+    bool empty() const { return _cmds.empty(); }
+
+    // stats of the last sort.
+    const stats& last_stats() const { return _stats; }
+};
+
+} // namespace hera
+
+#endif
@@ -16,15 +16,44 @@
 
 #include <hera/window.hpp>
 #include <hera/render/renderer.hpp>
+#include <hera/render/light.hpp>
 #include <hera/io/link.hpp>
 
 namespace hera {
 
-Renderer::Renderer(const Config&, Private) : _window{glfwGetCurrentContext()}
+namespace {
+// `render.max_point_lights` in the shipped config.
+constexpr size_t default_point_lights = 64;
+} // namespace
+
+Renderer::Renderer(const Config& cfg, Private)
+    : _window{glfwGetCurrentContext()},
+      _stream{static_cast<size_t>(cfg.at<int>("render.stream_kb")) * 1024},
+      _uploader{static_cast<size_t>(cfg.at<int>("render.upload_mb")) * 1024 *
+                1024}
 {
     LOG_DEBUG("init renderer");
-    path shaderpath = link::apply("hera:shaders");
-    shaders.load(shaderpath);
+    // the point light array must fit in a single uniform block.
+    size_t max_block = gl::get<GLint>(GL_MAX_UNIFORM_BLOCK_SIZE);
+    size_t max_lights = max_block / sizeof(PointLight::block);
+    const int want_lights = cfg.at<int>("render.max_point_lights");
+    if (want_lights < 1) {
+        // a zero-length array doesn't compile.
+        LOG_WARNING("render.max_point_lights: {} is below 1, using {}",
+                    want_lights, default_point_lights);
+        _max_point_lights = default_point_lights;
+    }
+    else {
+        _max_point_lights = want_lights;
+    }
+    if (_max_point_lights > max_lights) {
+        LOG_WARNING("render.max_point_lights: {} exceeds limit: {}",
+                    _max_point_lights, max_lights);
+        _max_point_lights = max_lights;
+    }
+    shaders.define("MAX_POINT_LIGHTS", std::to_string(_max_point_lights));
+
+    shaders.load(link{"hera:shaders"});
     LOG_INFO("{}", *this);
     LOG_DEBUG("init renderer done");
 }
@@ -56,4 +85,39 @@ const gl::Pipeline& Renderer::pipeline(string_view name)
     return p;
 }
 
+// =====[Frame]=====
+
+const gl::Pipeline& Renderer::Frame::use(string_view name)
+{
+    const auto& p = rdr.shaders.pipeline(name);
+    rdr._queue.use(p);
+    return p;
+}
+
+void Renderer::Frame::flush()
+{
+    auto& q = rdr._queue;
+    if (q.empty()) {
+        return;
+    }
+    gl::debug_group group{"render queue"};
+    q.sort();
+
+    optional<uint64_t> prev;
+    for (const auto& cmd : q.commands()) {
+        auto pipe = sort_key::pipeline(cmd.key);
+        bool new_pipe = !prev || pipe != sort_key::pipeline(*prev);
+        if (new_pipe) {
+            rdr.shaders.active(q.pipeline(pipe));
+        }
+        // material uniforms live in the program, so a new pipeline rebinds.
+        const auto mat = sort_key::material(cmd.key);
+        bool rebind = new_pipe || mat == sort_key::unique_material ||
+                      mat != sort_key::material(*prev);
+        cmd.drawable->execute(*this, cmd, rebind);
+        prev = cmd.key;
+    }
+    q.clear();
+}
+
 } // namespace hera
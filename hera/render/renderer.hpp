@@ -23,13 +23,23 @@
 #include <hera/config.hpp>
 #include <hera/input.hpp>
 #include <hera/gl/program.hpp>
+#include <hera/gl/stream.hpp>
+#include <hera/gl/upload.hpp>
 #include <hera/render/camera.hpp>
+#include <hera/render/queue.hpp>
 
 namespace hera {
 
 class Renderer {
 private:
     GLFWwindow* _window;
+    // persists between frames to keep its storage.
+    RenderQueue _queue;
+    size_t _max_point_lights;
+    // transient per-frame vertex data.
+    gl::StreamBuffer _stream;
+    // texture staging, destroyed with the renderer before the context is.
+    gl::TextureUploader _uploader;
 
     struct Private {
         explicit Private() = default;
@@ -53,6 +63,12 @@ public:
     const gl::Pipeline& pipeline(string_view name);
     const gl::Pipeline& pipeline() const;
 
+    // length of the point light array in shaders.
+    size_t max_point_lights() const { return _max_point_lights; }
+
+    gl::StreamBuffer& stream() { return _stream; }
+    gl::TextureUploader& uploader() { return _uploader; }
+
     class Frame {
     private:
         Renderer& rdr;
@@ -65,10 +81,23 @@ public:
         Frame(Frame&&) = delete;
         Frame& operator=(Frame&&) = delete;
 
-        ~Frame() { rdr.swap(); }
+        ~Frame()
+        {
+            flush();
+            rdr._stream.end_frame();
+            rdr.swap();
+        }
 
         Renderer& operator*() { return rdr; }
         Renderer* operator->() { return &rdr; }
+
+        RenderQueue& queue() { return rdr._queue; }
+
+        // sets the pipeline of subsequently queued commands and returns it.
+        const gl::Pipeline& use(string_view name);
+
+        // sorts and executes the queued commands.
+        void flush();
     };
 
     void swap() { glfwSwapBuffers(_window); }
@@ -87,6 +116,19 @@ public:
     virtual ~Drawable() = default;
 
     virtual void draw(Frame& f, float alpha) const = 0;
+
+    // queues the drawable. by default a single command keyed on pipeline only.
+    virtual void submit(RenderQueue& q, float alpha) const
+    {
+        q.push(*this, alpha);
+    }
+
+    // executes a queued command. `rebind` is set when the material state
+    // differs from that of the previous command.
+    virtual void execute(Frame& f, const RenderCommand& cmd, bool) const
+    {
+        draw(f, cmd.alpha);
+    }
 };
 
 } // namespace hera
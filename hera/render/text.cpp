@@ -14,12 +14,19 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <cstring>
+
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
+
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
 
 #include <hera/input.hpp>
 #include <hera/config.hpp>
 #include <hera/utility.hpp>
+#include <hera/io/mapped.hpp>
 #include <hera/render/text.hpp>
 
 template<>
@@ -44,6 +51,8 @@ inline static void fterr(FT_Error ec)
 }
 
 namespace hera {
+namespace tbb = oneapi::tbb;
+
 namespace {
 struct Face {
     // FT_Face _face = nullptr;
@@ -108,6 +117,16 @@ struct Face {
 
     const FT_Size_Metrics& metrics() const { return _face->size->metrics; }
 
+    bool has_kerning() const { return FT_HAS_KERNING(_face.get()); }
+    // horizontal kerning between two glyph indices in 1/64 pixels.
+    FT_Pos kerning(FT_UInt left, FT_UInt right) const
+    {
+        FT_Vector kern;
+        fterr(FT_Get_Kerning(_face.get(), left, right, FT_KERNING_DEFAULT,
+                             &kern));
+        return kern.x;
+    }
+
     // {w,h} to fit any char (fixed width)
     ivec2 dims() const
     {
@@ -138,85 +157,563 @@ struct FTLibrary {
         fterr(FT_New_Face(_ftlib.get(), p.c_str(), 0, &f));
         return f;
     };
+
+    // face over a font file already in memory, which must outlive it.
+    Face new_face(span<const FT_Byte> data) const
+    {
+        FT_Face f;
+        fterr(FT_New_Memory_Face(_ftlib.get(), data.data(),
+                                 FT_Long(data.size()), 0, &f));
+        return f;
+    }
+
+    // sets the distance field spread of the sdf renderer in pixels.
+    void sdf_spread(FT_Int spread) const
+    {
+        fterr(FT_Property_Set(_ftlib.get(), "sdf", "spread", &spread));
+    }
 };
 } // namespace
 
-// returns val aligned to next multiple of 4
-static constexpr int align4(int val)
-{
-    assert(val >= 0);
-    return (val + 3) & ~0x03;
-}
+// a rendered glyph bitmap not yet in the atlas.
+struct Alphabet::raster {
+    glyph g;
+    vector<unsigned char> pixels;
+};
 
-static string default_alphabet()
-{
-    string buf;
-    for (char ch = 0; ch != std::numeric_limits<char>::max(); ++ch) {
-        buf.push_back(ch);
+// freetype faces are not thread-safe, so each worker opens its own over the
+// shared file contents, which may view a mapped archive.
+struct Alphabet::font {
+    struct worker {
+        FTLibrary lib;
+        Face face;
+    };
+
+    file_bytes data;
+    FT_Int spread;
+    // em size in pixels of sdf glyphs.
+    FT_UInt sdf_px;
+    // the main thread's face, opened on first use.
+    optional<worker> _main;
+    tbb::enumerable_thread_specific<worker> workers;
+
+    font(const link& l, FT_Int spread, FT_UInt sdf_px)
+        : data{l.read()}, spread{spread}, sdf_px{sdf_px},
+          workers{[this] -> worker { return open(); }}
+    {
     }
-    return buf;
-}
 
-static void add_char(Alphabet& alpha, const FT_GlyphSlotRec& glyph)
+    worker& main()
+    {
+        if (!_main) {
+            _main = open();
+        }
+        return *_main;
+    }
+
+    worker open() const
+    {
+        worker w;
+        w.face = w.lib.new_face(data.bytes());
+        if (sdf_px) {
+            w.lib.sdf_spread(spread);
+            w.face.pixel_sizes(0, sdf_px);
+        }
+        else {
+            w.face.char_size(16l * 64, 0);
+        }
+        return w;
+    }
+
+    // renders `ch` with `face`, as a distance field if sdf is enabled.
+    raster render(const Face& face, char32_t ch) const
+    {
+        if (sdf_px) {
+            // the sdf renderer works from the outline.
+            face.load_char(ch, FT_LOAD_DEFAULT | FT_LOAD_NO_BITMAP);
+            fterr(FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF));
+        }
+        else {
+            face.load_char(ch, FT_LOAD_RENDER);
+        }
+        const auto& slot = *face->glyph;
+        const auto& bmp = slot.bitmap;
+        // only using 1 byte per pixel.
+        assert(bmp.pixel_mode == FT_PIXEL_MODE_GRAY || bmp.rows == 0);
+
+        raster r{.g = {.size = {int(bmp.width), int(bmp.rows)},
+                       .bearing = {slot.bitmap_left, slot.bitmap_top},
+                       .advance = float(slot.advance.x >> 6)}};
+        r.pixels.resize(bmp.width * bmp.rows);
+        const unsigned char* src = bmp.buffer;
+        for (unsigned i = 0; i < bmp.rows; ++i, src += bmp.pitch) {
+            std::copy_n(src, bmp.width, &r.pixels[i * bmp.width]);
+        }
+        return r;
+    }
+};
+
+// =====[atlas cache]=====
+
+namespace {
+constexpr uint32_t atlas_magic = 0x54414C48; // "HLAT"
+constexpr uint32_t atlas_version = 2;
+
+// printable ascii, whose kerning pairs are tabulated.
+constexpr char32_t kern_first = 0x20;
+constexpr char32_t kern_last = 0x7F;
+constexpr size_t kern_n = kern_last - kern_first;
+
+constexpr bool in_kern_table(char32_t ch)
 {
-    const auto& bmp = glyph.bitmap;
-    ivec2 bearing{glyph.bitmap_left, glyph.bitmap_top};
-    int pitch = bmp.pitch;
-    ivec2 bsz{bmp.width, bmp.rows};
+    return ch >= kern_first && ch < kern_last;
+}
 
-    const auto& extents = alpha.extents;
-    const auto& padded = alpha.padded;
+struct atlas_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    // time the atlas took to build, for reporting savings.
+    int64_t build_ns;
+    ivec2 page_size;
+    ivec2 size;
+    ivec2 extents;
+    uint32_t pages;
+    uint32_t glyphs;
+    // entries of the kerning table, 0 if the font has no kerning.
+    uint32_t kerning;
+};
 
-    assert(alpha.size.y >= bsz.y);
-    assert(alpha.size.x >= bsz.x);
-    // only using 1 byte per pixel.
-    assert(pitch == bsz.x);
+struct atlas_record {
+    char32_t ch;
+    glyph g;
+    ShelfPacker::rect slot;
+};
+} // namespace
 
-    int dst_offset = ((extents.x - bearing.y) * padded.x) + bearing.x;
+// glyphs rasterized up front.
+static vector<char32_t> warm_set()
+{
+    vector<char32_t> ascii;
+    for (char32_t ch = 0x20; ch != 0x7F; ++ch) {
+        ascii.push_back(ch);
+    }
+    return ascii;
+}
 
-    int dst_idx = alpha.buffer.size();
-    alpha.buffer.resize(dst_idx + (padded.x * padded.y));
+bool Alphabet::load_cache(const path& file, uint64_t key)
+{
+    if (!fs::exists(file)) {
+        return false;
+    }
+    mapped_file map{file};
+    auto bytes = map.bytes();
+    atlas_header hdr;
+    if (bytes.size() < sizeof(hdr)) {
+        return false;
+    }
+    std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+    const size_t page_bytes = size_t(_page_size.x) * _page_size.y;
+    if (hdr.magic != atlas_magic || hdr.version != atlas_version ||
+        hdr.key != key || hdr.page_size != _page_size ||
+        hdr.pages == 0 || hdr.pages > _max_pages ||
+        (hdr.kerning != 0 && hdr.kerning != kern_n * kern_n) ||
+        bytes.size() != sizeof(hdr) + hdr.glyphs * sizeof(atlas_record) +
+                            hdr.pages * page_bytes +
+                            hdr.kerning * sizeof(float)) {
+        return false;
+    }
+    size = hdr.size;
+    extents = hdr.extents;
+
+    // packing is deterministic, so replaying the records rebuilds the
+    // shelves. a mismatch means the file is stale.
+    vector<ShelfPacker> packers(hdr.pages, ShelfPacker{_page_size});
+    auto records =
+        bytes.subspan(sizeof(hdr), hdr.glyphs * sizeof(atlas_record));
+    for (size_t i = 0; i != hdr.glyphs; ++i) {
+        atlas_record rec;
+        std::memcpy(&rec, records.data() + i * sizeof(rec), sizeof(rec));
+        if (rec.g.page < 0) {
+            emplace(rec.ch, rec.g, {});
+            continue;
+        }
+        auto r = size_t(rec.g.page) < packers.size()
+                     ? packers[rec.g.page].pack(rec.g.size)
+                     : nullopt;
+        if (!r || r->pos != rec.slot.pos || r->size != rec.slot.size) {
+            LOG_WARNING("font atlas cache {} is inconsistent", file);
+            clear();
+            return false;
+        }
+        emplace(rec.ch, rec.g, rec.slot);
+    }
 
-    unsigned char* src = bmp.buffer;
-    unsigned char* dst = &alpha.buffer[dst_idx] + dst_offset;
+    auto pixels = bytes.subspan(sizeof(hdr) + records.size(),
+                                hdr.pages * page_bytes);
+    texarray.bind(3);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    texarray.allocate(gl::internal_f::red, _page_size.x, _page_size.y,
+                      int(hdr.pages), pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (size_t i = 0; i != hdr.pages; ++i) {
+        auto src = pixels.subspan(i * page_bytes, page_bytes);
+        _pages.push_back({.packer = std::move(packers[i]),
+                          .pixels = {src.begin(), src.end()}});
+    }
+    _kern.resize(hdr.kerning);
+    std::memcpy(_kern.data(), pixels.data() + pixels.size(),
+                _kern.size() * sizeof(float));
+    _saved_build = chrono::nanoseconds{hdr.build_ns};
+    return true;
+}
 
-    for (int i = 0; i < bsz.y; ++i, src += pitch, dst += padded.x) {
-        std::copy_n(src, pitch, dst);
+void Alphabet::save_cache(const path& file, uint64_t key,
+                          clock::duration build) const
+{
+    atlas_header hdr{.magic = atlas_magic,
+                     .version = atlas_version,
+                     .key = key,
+                     .build_ns = duration_cast<chrono::nanoseconds>(build)
+                                     .count(),
+                     .page_size = _page_size,
+                     .size = size,
+                     .extents = extents,
+                     .pages = uint32_t(_pages.size()),
+                     .glyphs = uint32_t(_lru.size()),
+                     .kerning = uint32_t(_kern.size())};
+    try {
+        fs::create_directories(file.parent_path());
+        // written aside and renamed, so readers never see a partial file.
+        path tmp = file;
+        tmp += ".tmp";
+        {
+            ofstream out;
+            out.exceptions(ofstream::badbit | ofstream::failbit);
+            out.open(tmp, ios_base::binary | ios_base::trunc);
+            out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+            // oldest first, the order they were packed in.
+            for (slot_t i : _lru | views::reverse) {
+                const auto& e = _entries[i];
+                atlas_record rec{.ch = e.ch, .g = e.g, .slot = e.slot};
+                out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            }
+            for (const auto& pg : _pages) {
+                out.write(reinterpret_cast<const char*>(pg.pixels.data()),
+                          pg.pixels.size());
+            }
+            out.write(reinterpret_cast<const char*>(_kern.data()),
+                      _kern.size() * sizeof(float));
+        }
+        fs::rename(tmp, file);
+    }
+    catch (const std::exception& e) {
+        LOG_WARNING("cannot write font atlas cache {}: {}", file, e.what());
     }
 }
 
+// =====[Alphabet]=====
+
 Alphabet::Alphabet(const Config& config)
+    : _sdf{config.at<bool>("font.sdf")},
+      _page_size{config.at<int>("font.atlas_size")},
+      _max_pages{size_t(config.at<int>("font.atlas_pages"))}
 {
-    gl::checkerror();
-    path fontpath = config["font.regular"];
-    FTLibrary lib;
-    Face face = lib.new_face(fontpath.native());
-    face.char_size(16l * 64, 0);
-    size = face.dims();
-    extents = {face.ascender(), face.descender()};
-    padded = {align4(size.x), size.y};
-    auto letters = default_alphabet();
-    buffer.reserve(letters.size() * padded.x * padded.y);
-
-    int ch_idx = 0;
-    for (char ch : letters) {
-        face.load_char(ch, FT_LOAD_RENDER);
-        add_char(*this, *face->glyph);
-        charmap.emplace(ch, ch_idx);
-        ++ch_idx;
-    }
+    const auto start = clock::now();
+    const auto sdf_px = _sdf ? config.at<int>("font.sdf_px") : 0;
+    const auto spread = config.at<int>("font.sdf_spread");
+    _font = std::make_unique<font>(
+        link{config.at<string>("font.regular")}, spread, sdf_px);
+
     texarray.bind(3);
     gl::TextureParams params;
     params.wrap_s = GL_CLAMP_TO_EDGE;
     params.wrap_t = GL_CLAMP_TO_EDGE;
-    gl::checkerror();
     texarray.params(params);
-
-    gl::checkerror();
-    texarray.allocate(gl::internal_f::red, size.x, size.y, ch_idx, buffer);
+    gl::label(texarray, "glyph atlas");
+
+    const auto warm = warm_set();
+    // everything the rendered pixels depend on.
+    size_t key = boost::hash_range(_font->data.bytes().begin(),
+                                   _font->data.bytes().end());
+    boost::hash_combine(key, atlas_version);
+    boost::hash_combine(key, _sdf);
+    boost::hash_combine(key, _page_size.x);
+    boost::hash_combine(key, _page_size.y);
+    boost::hash_combine(key, boost::hash_range(warm.begin(), warm.end()));
+    if (_sdf) {
+        boost::hash_combine(key, sdf_px);
+        boost::hash_combine(key, spread);
+    }
+    else {
+        // bitmaps are rendered at a fixed point size for the current dpi.
+        const ivec2 dpi{input::dpi()};
+        boost::hash_combine(key, dpi.x);
+        boost::hash_combine(key, dpi.y);
+    }
+    const path file = get_local_dir() / "cache" /
+                      fmt::format("atlas-{:016x}.bin", uint64_t(key));
+
+    if (load_cache(file, key)) {
+        duration<float, std::milli> took = clock::now() - start;
+        duration<float, std::milli> saved = _saved_build - took;
+        LOG_INFO("font atlas cache hit: {} glyphs in {:.2f} ms, "
+                 "saved {:.2f} ms",
+                 _lru.size(), took.count(), saved.count());
+    }
+    else {
+        auto& face = _font->main().face;
+        size = face.dims();
+        extents = {face.ascender(), face.descender()};
+        grow();
+        prepare(warm);
+        build_kerning();
+        const auto build = clock::now() - start;
+        save_cache(file, key, build);
+        LOG_INFO("font atlas cache miss: built {} glyphs in {:.2f} ms",
+                 _lru.size(),
+                 duration<float, std::milli>{build}.count());
+    }
     gl::checkerror();
 }
 
+Alphabet::~Alphabet() = default;
+
+float Alphabet::scale() const
+{
+    if (!_sdf) {
+        return 1;
+    }
+    // 16pt at the current content scale.
+    return 16.0f * input::dpi().y / 72.0f / float(_font->sdf_px);
+}
+
+Alphabet::slot_t Alphabet::acquire(char32_t ch)
+{
+    if (slot_t i = lookup(ch); i != none) {
+        touch(span{&i, 1});
+        return i;
+    }
+    return insert(ch, _font->render(_font->main().face, ch));
+}
+
+void Alphabet::touch(span<const slot_t> slots)
+{
+    for (slot_t i : slots) {
+        auto& e = _entries[i];
+        e.used = _frame;
+        _lru.splice(_lru.begin(), _lru, e.lru);
+    }
+}
+
+void Alphabet::build_kerning()
+{
+    _kern.clear();
+    const auto& face = _font->main().face;
+    if (!face.has_kerning()) {
+        return;
+    }
+    _kern.resize(kern_n * kern_n);
+    for (char32_t l = kern_first; l != kern_last; ++l) {
+        const auto li = face.char_index(l);
+        for (char32_t r = kern_first; r != kern_last; ++r) {
+            _kern[(l - kern_first) * kern_n + (r - kern_first)] =
+                float(face.kerning(li, face.char_index(r))) / 64.0f;
+        }
+    }
+}
+
+float Alphabet::kerning(char32_t left, char32_t right)
+{
+    // fonts without kerning leave the table empty.
+    if (_kern.empty()) {
+        return 0;
+    }
+    if (in_kern_table(left) && in_kern_table(right)) {
+        return _kern[(left - kern_first) * kern_n + (right - kern_first)];
+    }
+    const auto& face = _font->main().face;
+    return float(face.kerning(face.char_index(left), face.char_index(right))) /
+           64.0f;
+}
+
+Alphabet::slot_t Alphabet::lookup(char32_t ch) const
+{
+    if (ch < _bmp.size()) {
+        return _bmp[ch];
+    }
+    auto it = _astral.find(ch);
+    return it != _astral.end() ? it->second : none;
+}
+
+Alphabet::slot_t Alphabet::emplace(char32_t ch, const glyph& g,
+                                   const ShelfPacker::rect& r)
+{
+    slot_t i;
+    if (!_free.empty()) {
+        i = _free.back();
+        _free.pop_back();
+    }
+    else {
+        i = slot_t(_entries.size());
+        _entries.emplace_back();
+    }
+    _lru.push_front(i);
+    _entries[i] = {.g = g, .slot = r, .used = _frame, .ch = ch,
+                   .lru = _lru.begin()};
+    if (ch < _bmp.size()) {
+        _bmp[ch] = i;
+    }
+    else {
+        _astral.insert_or_assign(ch, i);
+    }
+    return i;
+}
+
+void Alphabet::erase(slot_t i)
+{
+    const auto& e = _entries[i];
+    if (e.g.page >= 0) {
+        _pages[e.g.page].packer.release(e.slot);
+    }
+    if (e.ch < _bmp.size()) {
+        _bmp[e.ch] = none;
+    }
+    else {
+        _astral.erase(e.ch);
+    }
+    _lru.erase(e.lru);
+    _free.push_back(i);
+}
+
+void Alphabet::clear()
+{
+    _entries.clear();
+    _free.clear();
+    ranges::fill(_bmp, none);
+    _astral.clear();
+    _lru.clear();
+}
+
+void Alphabet::prepare(span<const char32_t> chars)
+{
+    vector<char32_t> missing;
+    for (char32_t ch : chars) {
+        if (lookup(ch) == none && ranges::find(missing, ch) == missing.end()) {
+            missing.push_back(ch);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+    vector<raster> rasters(missing.size());
+    if (_sdf && missing.size() > 1) {
+        // distance fields are costly enough to spread across workers.
+        tbb::parallel_for(size_t{0}, missing.size(), [&](size_t i) {
+            const auto& face = _font->workers.local().face;
+            rasters[i] = _font->render(face, missing[i]);
+        });
+    }
+    else {
+        for (size_t i = 0; i != missing.size(); ++i) {
+            rasters[i] = _font->render(_font->main().face, missing[i]);
+        }
+    }
+    for (size_t i = 0; i != missing.size(); ++i) {
+        insert(missing[i], rasters[i]);
+    }
+}
+
+Alphabet::slot_t Alphabet::insert(char32_t ch, const raster& r)
+{
+    glyph g = r.g;
+    ShelfPacker::rect slot_rect{};
+
+    if (g.size.x > 0 && g.size.y > 0) {
+        auto packed = pack(g.size);
+        while (!packed && evict()) {
+            packed = pack(g.size);
+        }
+        if (!packed) {
+            LOG_WARNING("glyph atlas saturated, dropping U+{:04X}",
+                        uint32_t(ch));
+            return none;
+        }
+        auto [pg, rect] = *packed;
+        auto& pixels = _pages[pg].pixels;
+        for (int i = 0; i < g.size.y; ++i) {
+            std::copy_n(&r.pixels[i * g.size.x], g.size.x,
+                        &pixels[(rect.pos.y + i) * _page_size.x + rect.pos.x]);
+        }
+        upload(pg, rect.pos, g.size);
+        g.origin = rect.pos;
+        g.page = pg;
+        slot_rect = rect;
+    }
+
+    ++_rasterized;
+    return emplace(ch, g, slot_rect);
+}
+
+optional<pair<int, ShelfPacker::rect>> Alphabet::pack(ivec2 sz)
+{
+    for (int i = 0; i != int(_pages.size()); ++i) {
+        if (auto r = _pages[i].packer.pack(sz)) {
+            return pair{i, *r};
+        }
+    }
+    if (_pages.size() < _max_pages) {
+        grow();
+        if (auto r = _pages.back().packer.pack(sz)) {
+            return pair{int(_pages.size() - 1), *r};
+        }
+    }
+    return nullopt;
+}
+
+bool Alphabet::evict()
+{
+    if (_lru.empty()) {
+        return false;
+    }
+    // glyphs of this frame are already queued for drawing.
+    if (_entries[_lru.back()].used == _frame) {
+        return false;
+    }
+    erase(_lru.back());
+    ++_evicted;
+    return true;
+}
+
+void Alphabet::grow()
+{
+    _pages.push_back(
+        {.packer = ShelfPacker{_page_size},
+         .pixels = vector<unsigned char>(_page_size.x * _page_size.y)});
+    // layers can't be added in place, so reallocate and refill every page
+    // from its cpu copy.
+    texarray.bind(3);
+    texarray.allocate(gl::internal_f::red, _page_size.x, _page_size.y,
+                      int(_pages.size()));
+    for (int i = 0; i != int(_pages.size()); ++i) {
+        upload(i, {0, 0}, _page_size);
+    }
+    LOG_DEBUG("glyph atlas grew to {} pages", _pages.size());
+}
+
+void Alphabet::upload(int pg, ivec2 origin, ivec2 sz)
+{
+    span<const unsigned char> pixels{_pages[pg].pixels};
+    texarray.bind(3);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, _page_size.x);
+    gl::data(texarray.target, origin.x, origin.y, pg, sz.x, sz.y, 1,
+             pixels.subspan(origin.y * _page_size.x + origin.x),
+             gl::pixel_f::red);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 } // namespace hera
 
 namespace hera {
@@ -282,19 +779,198 @@ Scribe::Scribe(const Config& config) : vbuf{}, alphabet{config}
 {
     gl::checkerror();
     LOG_DEBUG("init text projector");
-    const auto quad = make_quad(float(alphabet.size.x), float(alphabet.size.y));
+    // unit quad, scaled per glyph.
+    const auto quad = make_quad(1, 1);
     vbuf.data(quad, quad_indices);
 }
 
-void Scribe::put(char ch, float x, float y, const gl::Pipeline& prog) const
+glyph_instance Scribe::place(const glyph& g, vec2 pos, float k,
+                             const vec4& color) const
+{
+    const vec2 texels{alphabet.page_size()};
+    const vec2 origin{g.origin};
+    const vec2 size{g.size};
+    const vec2 bearing{g.bearing};
+    const float baseline = pos.y - alphabet.extents.y * k;
+    return {.pos = {pos.x + bearing.x * k, baseline + (bearing.y - size.y) * k},
+            .size = size * k,
+            .uv = {origin / texels, (origin + size) / texels},
+            .layer = float(g.page),
+            .color = color};
+}
+
+float Scribe::put(char32_t ch, vec2 pos, const vec4& color)
+{
+    const float k = alphabet.scale();
+    const auto i = alphabet.acquire(ch);
+    if (i == Alphabet::none) {
+        return alphabet.size.x * k;
+    }
+    const auto& g = alphabet[i];
+    if (g.page >= 0) {
+        glyphs.push_back(place(g, pos, k, color));
+    }
+    return g.advance * k;
+}
+
+// decodes the code point at the front of `str` and drops it. malformed
+// sequences decode to U+FFFD one byte at a time.
+static char32_t next_codepoint(string_view& str)
+{
+    constexpr char32_t replacement = 0xFFFD;
+    const auto lead = static_cast<unsigned char>(str.front());
+    int len = lead < 0x80           ? 1
+              : (lead >> 5) == 0x06 ? 2
+              : (lead >> 4) == 0x0E ? 3
+              : (lead >> 3) == 0x1E ? 4
+                                    : 0;
+    if (len == 0 || int(str.size()) < len) {
+        str.remove_prefix(1);
+        return replacement;
+    }
+    char32_t cp = len == 1 ? lead : lead & (0x7F >> len);
+    for (int i = 1; i < len; ++i) {
+        const auto cont = static_cast<unsigned char>(str[i]);
+        if ((cont >> 6) != 0x02) {
+            str.remove_prefix(1);
+            return replacement;
+        }
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+    str.remove_prefix(len);
+    return cp;
+}
+
+vec2 Scribe::put(string_view str, vec2 pos, const vec4& color)
+{
+    return put(layout(str), pos, color);
+}
+
+vec2 Scribe::put(const TextLayout& lay, vec2 pos, const vec4& color)
 {
-    prog.uniform("glyph", 3);
-    alphabet.bind(3);
-    prog.uniform("origin", vec2{1 + x, 1 + y});
-    prog.uniform("text_color", vec3{0.0});
-    auto chidx = alphabet.charmap.at(ch);
-    prog.uniform("chidx", chidx);
-    vbuf.draw();
+    const size_t first = glyphs.size();
+    glyphs.insert(glyphs.end(), lay.glyphs.begin(), lay.glyphs.end());
+    for (auto& gi : span{glyphs}.subspan(first)) {
+        gi.pos += pos;
+        gi.color = color;
+    }
+    return pos + lay.end;
+}
+
+const TextLayout& Scribe::layout(string_view str, float wrap)
+{
+    const float k = alphabet.scale();
+    size_t key = boost::hash<string_view>{}(str);
+    boost::hash_combine(key, k);
+    boost::hash_combine(key, wrap);
+
+    auto& lay = layouts[key];
+    if (lay.text != str || lay.scale != k || lay.wrap != wrap) {
+        lay.text = str;
+        lay.scale = k;
+        lay.wrap = wrap;
+        shape(lay);
+    }
+    else if (lay.epoch != alphabet.epoch()) {
+        // an eviction may have reused one of its slots.
+        shape(lay);
+    }
+    else {
+        alphabet.touch(lay.slots);
+    }
+    lay.used = frame;
+    return lay;
+}
+
+void Scribe::shape(TextLayout& lay)
+{
+    codepoints.clear();
+    for (string_view rest = lay.text; !rest.empty();) {
+        codepoints.push_back(next_codepoint(rest));
+    }
+    alphabet.prepare(codepoints);
+
+    const float k = lay.scale;
+    const float lh = alphabet.size.y * k;
+    lay.glyphs.clear();
+    lay.slots.clear();
+    vec2 pen{0};
+    char32_t prev = 0;
+    // first glyph and pen x of the word being placed.
+    size_t word = 0;
+    float word_x = 0;
+
+    for (char32_t ch : codepoints) {
+        if (ch == U'\n') {
+            pen = {0, pen.y - lh};
+            prev = 0;
+            word = lay.glyphs.size();
+            word_x = 0;
+            continue;
+        }
+        const auto i = alphabet.acquire(ch);
+        if (i == Alphabet::none) {
+            pen.x += alphabet.size.x * k;
+            prev = 0;
+            continue;
+        }
+        const auto& g = alphabet[i];
+        if (prev) {
+            pen.x += alphabet.kerning(prev, ch) * k;
+        }
+        prev = ch;
+
+        if (ch == U' ') {
+            pen.x += g.advance * k;
+            word = lay.glyphs.size();
+            word_x = pen.x;
+            continue;
+        }
+        // carry the whole word to the next line, unless it is the only
+        // word on this one.
+        if (lay.wrap > 0 && word_x > 0 && pen.x + g.advance * k > lay.wrap) {
+            for (auto& gi : span{lay.glyphs}.subspan(word)) {
+                gi.pos += vec2{-word_x, -lh};
+            }
+            pen += vec2{-word_x, -lh};
+            word_x = 0;
+        }
+        if (g.page >= 0) {
+            lay.glyphs.push_back(place(g, pen, k, vec4{1}));
+            lay.slots.push_back(i);
+        }
+        pen.x += g.advance * k;
+    }
+    lay.end = pen;
+    // after shaping, so evictions it caused don't invalidate it.
+    lay.epoch = alphabet.epoch();
+}
+
+void Scribe::draw(Frame& f)
+{
+    if (!glyphs.empty()) {
+        const auto& prog = f->pipeline("text");
+        alphabet.bind(3);
+        prog.uniform("glyph", alphabet.texarray.unit());
+        prog.uniform("sdf", int(alphabet.sdf()));
+
+        auto& stream = f->stream();
+        auto offset = stream.write(glyphs);
+        vbuf.instances<glyph_instance>(stream.buffer(), offset,
+                                       instance_attrib);
+
+        // overlays ignore the scene depth.
+        glDisable(GL_DEPTH_TEST);
+        vbuf.draw(static_cast<GLsizei>(glyphs.size()));
+        glEnable(GL_DEPTH_TEST);
+        glyphs.clear();
+    }
+    // forget strings that are no longer shown.
+    boost::unordered::erase_if(layouts, [&](const auto& kv) -> bool {
+        return frame - kv.second.used > layout_ttl;
+    });
+    ++frame;
+    alphabet.next_frame();
 }
 
 } // namespace hera
@@ -17,6 +17,8 @@
 #ifndef HERA_RENDER_TEXT_HPP
 #define HERA_RENDER_TEXT_HPP
 
+#include <list>
+
 #include <hera/common.hpp>
 #include <hera/error.hpp>
 #include <hera/utility.hpp>
@@ -25,33 +27,217 @@
 #include <hera/gl/texture.hpp>
 #include <hera/gl/buffer.hpp>
 #include <hera/gl/object.hpp>
+#include <hera/render/renderer.hpp>
+#include <hera/render/atlas.hpp>
 
 namespace hera {
 
-struct Alphabet {
+// a glyph resident in the atlas.
+struct glyph {
+    // texel origin and size of the bitmap within its page.
+    ivec2 origin;
+    ivec2 size;
+    // atlas page, or -1 for blank glyphs.
+    int page = -1;
+    // offset of the bitmap's top-left from the pen on the baseline.
+    ivec2 bearing;
+    float advance;
+};
+
+// glyphs packed into the pages of a texture array on demand.
+//
+// any char32_t is rasterized on first use and copied into the atlas with a
+// sub-image update. when every page is full the least recently used glyphs
+// are evicted, but never those already queued in the current frame.
+//
+// with `font.sdf` glyphs are stored as signed distance fields at a fixed em
+// size, so one atlas serves every text size and content scale.
+class Alphabet {
+public:
+    // index of a resident glyph, stable until it is evicted.
+    using slot_t = uint32_t;
+    static constexpr slot_t none = ~slot_t{0};
+
+    struct stats {
+        size_t glyphs;
+        size_t pages;
+        size_t rasterized;
+        size_t evicted;
+    };
+
     ivec2 size;
     ivec2 extents;
-    ivec2 padded;
-    vector<unsigned char> buffer;
-    // char -> texture index
-    hash_map<char32_t, int> charmap;
     gl::TextureArray texarray;
 
     Alphabet(const Config&);
+    ~Alphabet();
+
+    // slot of `ch`'s glyph, rasterizing it if needed. `none` if the atlas
+    // is saturated by this frame's glyphs.
+    slot_t acquire(char32_t ch);
+    const glyph& operator[](slot_t i) const { return _entries[i].g; }
+    // marks glyphs as used by this frame.
+    void touch(span<const slot_t> slots);
+    // horizontal kerning between two characters in atlas texels.
+    float kerning(char32_t left, char32_t right);
+    // advances whenever a glyph is evicted, invalidating held slots.
+    size_t epoch() const { return _evicted; }
+    // rasterizes every missing glyph of `chars` at once, in parallel for
+    // distance fields.
+    void prepare(span<const char32_t> chars);
+
+    // whether glyphs are distance fields.
+    bool sdf() const { return _sdf; }
+    // pixels per atlas texel at the current content scale. metrics are in
+    // atlas texels.
+    float scale() const;
+
+    // ends the frame, making its glyphs eligible for eviction.
+    void next_frame() { ++_frame; }
 
     void bind(gl::texture_u unit = 3) const { texarray.bind(unit); }
+
+    ivec2 page_size() const { return _page_size; }
+    stats last_stats() const
+    {
+        return {_lru.size(), _pages.size(), _rasterized, _evicted};
+    }
+
+private:
+    struct entry {
+        glyph g;
+        ShelfPacker::rect slot;
+        uint64_t used;
+        char32_t ch;
+        std::list<slot_t>::iterator lru;
+    };
+    struct page {
+        ShelfPacker packer;
+        // cpu copy of the page, kept for regrowing the array.
+        vector<unsigned char> pixels;
+    };
+    struct font;
+    struct raster;
+
+    slot_t lookup(char32_t) const;
+    slot_t emplace(char32_t, const glyph&, const ShelfPacker::rect&);
+    void erase(slot_t);
+    void clear();
+    slot_t insert(char32_t, const raster&);
+    // restores a saved atlas, false if `file` is missing or doesn't match.
+    bool load_cache(const path& file, uint64_t key);
+    void save_cache(const path& file, uint64_t key,
+                    clock::duration build) const;
+    // fills `_kern` from the font.
+    void build_kerning();
+    optional<pair<int, ShelfPacker::rect>> pack(ivec2 size);
+    bool evict();
+    void grow();
+    void upload(int page, ivec2 origin, ivec2 size);
+
+    bool _sdf;
+    unique_ptr<font> _font;
+    ivec2 _page_size;
+    size_t _max_pages;
+    vector<page> _pages;
+    vector<entry> _entries;
+    vector<slot_t> _free;
+    // slots of the basic multilingual plane, indexed directly.
+    vector<slot_t> _bmp = vector<slot_t>(0x10000, none);
+    hash_map<char32_t, slot_t> _astral;
+    // resident slots, most recently used first.
+    std::list<slot_t> _lru;
+    uint64_t _frame = 0;
+    size_t _rasterized = 0;
+    size_t _evicted = 0;
+    // build time recorded in the loaded cache.
+    clock::duration _saved_build{0};
+    // kerning between printable ascii pairs, indexed [left][right]. empty if
+    // the font has no kerning, so cached atlases never open the face for it.
+    vector<float> _kern;
+};
+
+// per-glyph attributes of batched text.
+struct glyph_instance {
+    // bottom-left of the glyph quad in pixels.
+    vec2 pos;
+    vec2 size;
+    // {left, top, right, bottom} texture coordinates.
+    vec4 uv;
+    // texture array layer of the glyph's page.
+    float layer;
+    vec4 color;
 };
 
+template<>
+struct gl::vertex<glyph_instance>
+    : attributes<vec2, vec2, vec4, float, vec4> {};
+
+// a string shaped once into glyph quads.
+//
+// positions are relative to the bottom-left of the first line's cell and
+// colors are filled in when the layout is queued.
+struct TextLayout {
+    string text;
+    float scale = 0;
+    float wrap = 0;
+    vector<glyph_instance> glyphs;
+    // atlas slots of `glyphs`, kept resident while the layout is drawn.
+    vector<Alphabet::slot_t> slots;
+    // pen position after the last glyph.
+    vec2 end{0};
+    // Alphabet::epoch() when the slots were resolved.
+    size_t epoch = 0;
+    // last frame the layout was queued in.
+    uint64_t used = 0;
+};
+
+// batched text rendering.
+//
+// glyphs are queued by `put` and drawn together as instances of one quad.
+// strings are shaped through a cache of layouts, so unchanged text only
+// costs a copy of its instances.
 struct Scribe {
+    // first attribute location of the per-glyph stream.
+    static constexpr GLuint instance_attrib = 1;
+    // frames an unused layout stays cached.
+    static constexpr uint64_t layout_ttl = 120;
+
     gl::VertexBuffer vbuf;
     Alphabet alphabet;
+    // glyphs queued since the last draw.
+    vector<glyph_instance> glyphs;
+    // decoded code points of the string being shaped.
+    vector<char32_t> codepoints;
+    // layouts by hash of {text, scale, wrap}.
+    hash_map<size_t, TextLayout> layouts;
+    uint64_t frame = 0;
 
     Scribe(const Config&);
 
-    void put(char, float x, float y, const gl::Pipeline&) const;
-    void put(char32_t, float x, float y, const gl::Pipeline&) const;
+    // queues a glyph with its cell's bottom-left at `pos`, returning its
+    // advance.
+    float put(char32_t, vec2 pos, const vec4& color = vec4{1});
+    // queues a utf-8 string, returning the pen position after it.
+    vec2 put(string_view, vec2 pos, const vec4& color = vec4{1});
+    // queues a shaped string, returning the pen position after it.
+    vec2 put(const TextLayout&, vec2 pos, const vec4& color = vec4{1});
+
+    // the cached layout of a utf-8 string, shaping it if it changed. lines
+    // longer than a non-zero `wrap` pixels break at spaces.
+    const TextLayout& layout(string_view, float wrap = 0);
+
+    // height of a line in pixels.
+    float line_height() const { return alphabet.size.y * alphabet.scale(); }
+
+    // draws every queued glyph in one instanced draw.
+    void draw(Frame&);
 
-    void put(string_view, float x, float y, const gl::Pipeline&) const;
+private:
+    void shape(TextLayout&);
+    // instance of a glyph drawn with its cell's bottom-left at `pos`.
+    glyph_instance place(const glyph&, vec2 pos, float scale,
+                         const vec4& color) const;
 };
 
 } // namespace hera
@@ -23,6 +23,7 @@
 #include <hera/event.hpp>
 #include <hera/ui.hpp>
 #include <hera/io/assets.hpp>
+#include <hera/io/image.hpp>
 #include <hera/render/model.hpp>
 
 using hera::Cube;
@@ -71,31 +72,167 @@ void State::do_update()
 
 void State::do_render()
 {
+    auto frame_start = clock::now();
     Frame frame{*renderer};
     const float delta = ticker.delta();
+    auto& queue = frame.queue();
+    queue.eye(camera->position(), camera->zfar());
+    camera->flush();
 
-    auto&& p = frame->pipeline("scene");
-    dir_light.load_into("dir_light", p);
     for (auto i = 0u; i < plights.size(); ++i) {
-        plights[i].load_into(std::format("point_lights[{}]", i), p);
+        lights.set(i, plights[i]);
     }
-    int npl = plights.size();
-    p.uniform("n_point_lights", npl);
-    for (const auto& cube : cubes) {
-        cube.draw(frame, delta);
+    lights.resize(plights.size());
+    lights.flush();
+    {
+        gl::debug_group group{"light clusters"};
+        clusters.update(*camera, plights);
+    }
+
+    if (props.empty() && backpack.ready()) {
+        vector<vec3> places{{4.0, 0.0, -8.0}};
+        // benchmark copies in rows of ten, receding from the camera.
+        const auto n_bench = config.at<int>("bench.backpacks");
+        for (int i = 0; i < n_bench; ++i) {
+            places.emplace_back((i % 10 - 4.5f) * 3.0f, -4.0f,
+                                -12.0f - (i / 10) * 4.0f);
+        }
+        for (const auto& pos : places) {
+            auto& prop = props.emplace_back(backpack.get());
+            const mat4 place = glm::translate(mat4{1.0}, pos);
+            // twice, so the first frame doesn't interpolate from the origin.
+            prop.model(place);
+            prop.model(place);
+        }
     }
 
-    frame->pipeline("lamp");
+    // cubes take the first indices, then the props, then the lamps.
+    culler.clear();
+    for (const auto& cube : cubes) {
+        culler.add(cube.bounds());
+    }
+    for (const auto& prop : props) {
+        culler.add(prop.bounds());
+    }
     for (const auto& pl : plights) {
-        pl.draw(frame, delta);
+        culler.add(pl.bounds());
     }
+    const size_t first_lamp = cubes.size() + props.size();
+    auto visible = culler.cull(camera->frustum());
+    auto shown_props = ranges::partition_point(
+        visible, [&](uint32_t i) { return i < cubes.size(); });
+    auto lamps = ranges::partition_point(
+        visible, [&](uint32_t i) { return i < first_lamp; });
+
+    frame.use("scene");
+    clusters.load_into(renderer->shaders.pipeline("scene"), *camera);
+    for (auto i : ranges::subrange(visible.begin(), shown_props)) {
+        batch.add(cubes[i], delta);
+    }
+    batch.submit(queue, delta);
+    props_drawn = 0;
+    prop_triangles = 0;
+    for (auto i : ranges::subrange(shown_props, lamps)) {
+        auto& prop = props[i - cubes.size()];
+        if (lod_enabled) {
+            prop.select_lod(*camera, lod);
+        }
+        else {
+            prop.reset_lod();
+        }
+        prop.submit(queue, delta);
+        ++props_drawn;
+        prop_triangles += prop.triangles();
+    }
+
+    frame.use("lamp");
+    for (auto i : ranges::subrange(lamps, visible.end())) {
+        plights[i - first_lamp].submit(queue, delta);
+    }
+    frame.flush();
+
+    // overlay
+    const vec2 top{8, camera->viewport().y - 8 - scribe.line_height()};
+    scribe.put(fmt::format("frame {:6.2f} ms\nlights {}\ndrawn {}",
+                           frame_time.count(), plights.size(),
+                           culler.last_stats().visible),
+               top, vec4{1.0, 1.0, 0.8, 1.0});
+    scribe.draw(frame);
 
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     ImGui::ShowDemoWindow();
+    if (ImGui::Begin("render")) {
+        const auto& st = queue.last_stats();
+        ImGui::Text("commands: %zu", st.commands);
+        ImGui::Text("state changes: %zu (%zu saved by sort)",
+                    st.sorted.total(), st.saved());
+        ImGui::Text("batches: %zu draws, %zu instances", batch.draws(),
+                    batch.instances());
+        const auto& cs = culler.last_stats();
+        ImGui::Text("culling: %zu drawn, %zu culled", cs.visible,
+                    cs.culled());
+        const auto& ss = renderer->stream().last_stats();
+        ImGui::Text("streamed: %zu bytes, %zu waits", ss.bytes, ss.waits);
+        const auto& bs = gl::state().counters();
+        ImGui::Text("binds: %zu issued, %zu elided", bs.issued, bs.elided);
+        ImGui::Text("assets loading: %zu", assets::loading());
+        const auto is = assets::stats<image_data>();
+        ImGui::Text("images: %zu hits, %zu misses, %zu coalesced, %.1f ms",
+                    is.hits, is.misses, is.coalesced, is.load_time.count());
+        ImGui::Text("image cache: %zu / %zu KiB, %zu evicted",
+                    is.bytes / 1024, is.budget / 1024, is.evicted);
+        const auto us = renderer->uploader().counters();
+        ImGui::Text("textures: %zu uploaded, %zu KiB, %zu staged off-thread, "
+                    "%zu direct, %zu pending",
+                    us.uploads, us.bytes / 1024, us.staged, us.direct,
+                    us.pending);
+        if (!props.empty()) {
+            const auto& src = props.front().source();
+            const auto& ms = src.last_stats();
+            ImGui::Text("backpack%s: %zu triangles, %zu draws, "
+                        "%zu textures, %.1f ms import, %.1f ms process",
+                        ms.cooked ? " (cooked)" : "", ms.triangles,
+                        src.level(0).size(), ms.textures,
+                        ms.import_time.count(), ms.process_time.count());
+            ImGui::Checkbox("levels of detail", &lod_enabled);
+            ImGui::Text("props: %zu drawn, %zu triangles (%zu at full "
+                        "detail), %zu levels",
+                        props_drawn, prop_triangles,
+                        props_drawn * ms.triangles, src.lods.size());
+        }
+        const auto gs = scribe.alphabet.last_stats();
+        ImGui::Text("glyphs: %zu in %zu pages, %zu rasterized, %zu evicted",
+                    gs.glyphs, gs.pages, gs.rasterized, gs.evicted);
+    }
+    ImGui::End();
+    if (ImGui::Begin("lighting")) {
+        const auto& st = clusters.last_stats();
+        ImGui::Checkbox("clustered", &clusters.enabled);
+        ImGui::Text("point lights: %zu (uniform path shades %zu)",
+                    plights.size(),
+                    std::min(plights.size(), renderer->max_point_lights()));
+        ImGui::Text("frame: %.2f ms", frame_time.count());
+        if (clusters.enabled) {
+            ImGui::Text("assign: %.3f ms", st.assign_time.count());
+            ImGui::Text("references: %zu, max per froxel: %zu",
+                        st.references, st.max_lights);
+        }
+    }
+    ImGui::End();
+    if constexpr (HERA_CHECK_GL_STATE) {
+        gl::state().validate();
+    }
+    gl::state().reset_counters();
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    {
+        gl::debug_group group{"imgui"};
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
+    // imgui binds behind the cache.
+    gl::state().invalidate();
+    frame_time = clock::now() - frame_start;
 }
 
 void State::do_input()
@@ -153,7 +290,23 @@ void State::prologue()
     plights.push_back(PointLight{{-4.0, 2.0, -12.0}});
     plights.push_back(PointLight{{0.0, 0.0, -3.0}});
 
-    auto x = assets::get<Model>(link{"hera:data/backpack/backpack.obj"});
+    // extra short-range lights for benchmarking the lighting paths.
+    const auto n_bench = config.at<int>("bench.point_lights");
+    std::uniform_real_distribution<float> rspread{-8.0, 8.0};
+    for (int i = 0; i < n_bench; ++i) {
+        PointLight pl{{rspread(rgen), rspread(rgen), rspread(rgen) - 6.0f}};
+        pl.linear = 0.7;
+        pl.quadratic = 1.8;
+        pl.ambient = vec3{0};
+        pl.diffuse = randvec3();
+        plights.push_back(std::move(pl));
+    }
+
+    lights.set(dir_light);
+
+    backpack = assets::get_async<Model>(
+        link{"hera:data/backpack/backpack.obj"},
+        [](const auto& model) { model->upload(); });
 
     do_input();
     gl::checkerror();
@@ -164,11 +317,28 @@ void State::prologue()
 
 void State::epilogue() {}
 
+void State::reload_changed()
+{
+    if (!watcher) {
+        return;
+    }
+    for (const auto& file : watcher->poll()) {
+        route_table::touch(file);
+        auto n_assets = assets::invalidate(file);
+        auto n_shaders = renderer->shaders.reload(file);
+        LOG_INFO("changed: {} ({} assets, {} shaders)", file, n_assets,
+                 n_shaders);
+    }
+}
+
 void State::preamble()
 {
     gl::checkerror();
     // timestep
     ticker.push();
+    reload_changed();
+    renderer->uploader().poll();
+    assets::finalize(duration_cast<clock::duration>(finalize_budget));
 }
 
 void State::postamble()
@@ -181,6 +351,13 @@ void State::postamble()
          * LOG_DEBUG("rps: {}", render_steps / diff.count());
          * LOG_DEBUG("ups: {}", update_steps / diff.count());
          */
+        if (plights.size() > 4) {
+            LOG_DEBUG("lights: {} {}, frame {:.2f}ms, assign {:.3f}ms",
+                      plights.size(),
+                      clusters.enabled ? "clustered" : "uniform",
+                      frame_time.count(),
+                      clusters.last_stats().assign_time.count());
+        }
         last_stat = now_time;
         render_steps = update_steps = 0;
     }
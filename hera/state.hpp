@@ -22,9 +22,17 @@
 #include <hera/init.hpp>
 #include <hera/input.hpp>
 #include <hera/tick.hpp>
+#include <hera/io/assets.hpp>
+#include <hera/io/router.hpp>
+#include <hera/io/watch.hpp>
+#include <hera/render/batch.hpp>
+#include <hera/render/cluster.hpp>
 #include <hera/render/cube.hpp>
+#include <hera/render/cull.hpp>
 #include <hera/render/light.hpp>
+#include <hera/render/model.hpp>
 #include <hera/render/renderer.hpp>
+#include <hera/render/text.hpp>
 
 namespace hera {
 
@@ -44,6 +52,7 @@ public:
     long update_steps = 0;
 
     clock::time_point last_stat = clock::now();
+    duration<float, std::milli> frame_time{0};
 
     // state data
     float angle = 0;
@@ -59,15 +68,43 @@ public:
     // render data
     vector<Cube> cubes;
     vector<vec3> cube_pos;
+    GeometryBatch batch;
+    Culler culler;
 
     DirLight dir_light;
     vector<PointLight> plights;
+    LightBlock lights{renderer->max_point_lights()};
+    LightClusters clusters{renderer->shaders.pipeline("scene")};
     shared_ptr<Camera> camera = Camera::create();
+    Scribe scribe{config};
+    asset_handle<Model> backpack;
+    // placed once the backpack has loaded: the first in the scene, then any
+    // benchmark copies.
+    vector<Prop> props;
+    lod_policy lod{config.at<float>("lod.pixel_error"),
+                   config.at<float>("lod.hysteresis")};
+    bool lod_enabled = config.at<bool>("lod.enabled");
+    // props and their triangles submitted last frame.
+    size_t props_drawn = 0;
+    size_t prop_triangles = 0;
+    // main-thread time per frame for finishing async loads.
+    duration<float, std::milli> finalize_budget{
+        config.at<float>("assets.finalize_ms")};
+    // picks up edited shaders and assets between frames.
+    optional<file_watcher> watcher;
 
     State(Private) : window{glfwGetCurrentContext()}, dir_light{{0, -1.0, 0}}
     {
         gl::checkerror();
+        assets::configure(config);
         camera->load_into(renderer->shaders);
+        lights.load_into(renderer->shaders);
+        if (config.at<bool>("filesystem.watch")) {
+            watcher.emplace();
+            for (const auto& root : route_table::roots()) {
+                watcher->watch(root);
+            }
+        }
     };
 
     static shared_ptr<State> create()
@@ -99,6 +136,9 @@ public:
     // run once after entire loop.
     void epilogue();
 
+    // reloads whatever changed on disk since the last call.
+    void reload_changed();
+
     // run once before each loop iteration.
     void preamble();
     // run once after each loop iteration.
@@ -68,6 +68,7 @@ GLFWwindow* init::window()
 #if defined(DARWIN)
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
 #endif
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, HERA_DEBUG);
 
     GLFWwindow* window = glfwCreateWindow(1200, 800, "hera", nullptr, nullptr);
     if (!window) {
@@ -0,0 +1,83 @@
+// hera
+// Copyright (C) 2024-2025  Cole Reynolds
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// hera_cook: imports models ahead of time into the cooked mesh cache, so the
+// engine's first start skips assimp as well.
+//
+// usage: hera_cook [--force] LINK...
+//
+// each cooked model reports its vertex cache behaviour before and after
+// optimization, which doubles as a benchmark of the optimizer.
+
+#include <hera/error.hpp>
+#include <hera/init.hpp>
+#include <hera/render/model.hpp>
+
+#include <iostream>
+
+using namespace hera;
+
+int main(int argc, char** argv)
+try {
+    init::logging();
+    init::error();
+    init::config();
+    init::route_table();
+
+    // flags apply to every link, wherever they appear.
+    bool force = false;
+    vector<string_view> links;
+    for (int i = 1; i < argc; ++i) {
+        const string_view arg = argv[i];
+        if (arg == "--force") {
+            force = true;
+        }
+        else {
+            links.push_back(arg);
+        }
+    }
+
+    int failed = 0;
+    for (const auto arg : links) {
+        try {
+            const link src{arg};
+            const path out = asset<Model>::cooked_path(src);
+            if (!force && fs::exists(out)) {
+                std::cout << fmt::format("{}: up to date\n", src);
+                continue;
+            }
+            auto model = asset<Model>::import(src);
+            asset<Model>::cook(*model, out);
+            const auto& st = model->last_stats();
+            std::cout << fmt::format("{}: {}\n", src, out);
+            std::cout << fmt::format(
+                "  {} triangles, acmr {:.3f} -> {:.3f}, "
+                "atvr {:.3f} -> {:.3f}, processed in {:.1f} ms\n",
+                st.triangles, st.cache_before.acmr(), st.cache_after.acmr(),
+                st.cache_before.atvr(), st.cache_after.atvr(),
+                st.process_time.count());
+        }
+        catch (const std::exception& e) {
+            std::cerr << arg << ": " << e.what() << '\n';
+            ++failed;
+        }
+    }
+    return failed ? 1 : 0;
+}
+catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+}
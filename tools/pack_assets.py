@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+"""Packs asset files into a single archive for hera's archive router.
+
+usage: pack_assets.py -o OUTPUT [-C DIR] FILE...
+
+Each FILE is stored under its path relative to DIR (default: the current
+directory). The layout, with all integers little-endian, is:
+
+    header   magic "HPAK", version, entry count, name table size (u32 each)
+    entries  blob offset (u64), blob size (u64), name offset (u32),
+             name size (u32), one per file
+    names    '/'-separated relative paths, concatenated
+    blobs    file contents, each aligned to ALIGNMENT bytes
+
+Keep in sync with hera/io/archive.hpp.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = 0x4B415048
+VERSION = 1
+ALIGNMENT = 64
+
+HEADER = struct.Struct('<4I')
+ENTRY = struct.Struct('<2Q2I')
+
+
+def align(n):
+    """Rounds n up to the next multiple of ALIGNMENT."""
+    return (n + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def pack(output, base, files):
+    """Writes the archive of files, named relative to base, to output."""
+    names = {}
+    for f in files:
+        rel = os.path.relpath(os.path.abspath(f), base).replace(os.sep, '/')
+        if rel.startswith('../'):
+            sys.exit(f'pack_assets: {f} is outside {base}')
+        names[rel] = f
+    order = sorted(names)
+
+    table = bytearray()
+    name_at = []
+    for rel in order:
+        name_at.append((len(table), len(rel.encode())))
+        table += rel.encode()
+
+    offset = align(HEADER.size + ENTRY.size * len(order) + len(table))
+    entries = []
+    for rel, (noff, nsize) in zip(order, name_at):
+        size = os.path.getsize(names[rel])
+        entries.append(ENTRY.pack(offset, size, noff, nsize))
+        offset = align(offset + size)
+
+    tmp = output + '.tmp'
+    with open(tmp, 'wb') as out:
+        out.write(HEADER.pack(MAGIC, VERSION, len(order), len(table)))
+        for e in entries:
+            out.write(e)
+        out.write(table)
+        for rel in order:
+            out.write(b'\0' * (align(out.tell()) - out.tell()))
+            with open(names[rel], 'rb') as src:
+                out.write(src.read())
+    os.replace(tmp, output)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='pack hera asset archives')
+    parser.add_argument('-o', '--output', required=True)
+    parser.add_argument('-C', '--directory', default='.')
+    parser.add_argument('files', nargs='+')
+    args = parser.parse_args()
+    pack(args.output, os.path.abspath(args.directory), args.files)
+
+
+if __name__ == '__main__':
+    main()